@@ -0,0 +1,312 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
+import java.io.File;
+import java.io.IOException;
+import java.io.OutputStream;
+import java.lang.management.ManagementFactory;
+import java.lang.management.ThreadMXBean;
+import java.nio.ByteBuffer;
+import java.nio.charset.StandardCharsets;
+import java.nio.file.Files;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+import java.util.Random;
+import java.util.zip.DataFormatException;
+import java.util.zip.Deflater;
+import java.util.zip.Inflater;
+
+
+/**
+ * Measures the decompression speed of the various ways of using this library, and of the JDK's inflater for reference.
+ * <p>Usage: java DecompressorBenchmark [-t Seconds] [File/Directory ...]</p>
+ * <p>Without arguments this runs on synthetic data that exercises stored blocks, dynamic Huffman blocks,
+ * long matches, and tiny payloads (which are mostly coded with the fixed Huffman code). Otherwise each given
+ * file (or each file in a given directory, such as the Silesia or Canterbury corpus or slices of enwik8)
+ * is compressed at the default level and measured. For each method, this prints the decompressed
+ * throughput in MB/s (10^6 bytes per second) and the number of bytes allocated per decompressed byte
+ * (if the JVM can measure it). The sources in the src directory must be on the class path.</p>
+ */
+public final class DecompressorBenchmark {
+	
+	public static void main(String[] args) throws IOException, DataFormatException {
+		// Handle command line arguments
+		double seconds = 3;
+		int argIndex = 0;
+		if (args.length >= 2 && args[0].equals("-t")) {
+			seconds = Double.parseDouble(args[1]);
+			argIndex = 2;
+		}
+		List<Case> cases = new ArrayList<>();
+		if (argIndex == args.length)
+			addSyntheticCases(cases);
+		for (; argIndex < args.length; argIndex++)
+			addFileCases(new File(args[argIndex]), cases);
+		
+		System.out.printf("%-24s %-24s %10s %12s%n", "Case", "Method", "MB/s", "Alloc B/B");
+		for (Case c : cases) {
+			for (Method m : METHODS) {
+				// Check the output once before timing
+				m.checking = true;
+				m.run(c);
+				m.checking = false;
+				if (!Arrays.equals(m.lastOutput, c.lastPayload))
+					throw new AssertionError("Output mismatch: " + m.name + " on " + c.name);
+				double[] result = measure(m, c, seconds);
+				System.out.printf("%-24s %-24s %10.1f %12s%n", c.name, m.name, result[0],
+					Double.isNaN(result[1]) ? "N/A" : String.format("%.3f", result[1]));
+			}
+		}
+	}
+	
+	
+	// Runs the method on the case repeatedly, first to warm up and then for the given duration.
+	// Returns the throughput in MB/s and the bytes allocated per decompressed byte (or NaN).
+	private static double[] measure(Method m, Case c, double seconds) throws IOException, DataFormatException {
+		long warmupEnd = System.nanoTime() + (long)(seconds / 3 * 1e9);
+		while (System.nanoTime() < warmupEnd)
+			m.run(c);
+		
+		long startAlloc = getAllocatedBytes();
+		long start = System.nanoTime();
+		long end = start + (long)(seconds * 1e9);
+		long iterations = 0;
+		long now;
+		do {
+			m.run(c);
+			iterations++;
+			now = System.nanoTime();
+		} while (now < end);
+		long alloc = getAllocatedBytes() - startAlloc;
+		
+		double bytes = (double)c.uncompressedSize * iterations;
+		return new double[]{bytes / ((now - start) / 1e3), startAlloc == -1 ? Double.NaN : alloc / bytes};
+	}
+	
+	
+	// Returns the number of bytes allocated by the current thread so far, or -1 if the JVM cannot tell.
+	private static long getAllocatedBytes() {
+		ThreadMXBean bean = ManagementFactory.getThreadMXBean();
+		if (!(bean instanceof com.sun.management.ThreadMXBean))
+			return -1;
+		com.sun.management.ThreadMXBean sunBean = (com.sun.management.ThreadMXBean)bean;
+		if (!sunBean.isThreadAllocatedMemorySupported() || !sunBean.isThreadAllocatedMemoryEnabled())
+			return -1;
+		return sunBean.getThreadAllocatedBytes(Thread.currentThread().getId());
+	}
+	
+	
+	
+	/*---- Benchmark inputs ----*/
+	
+	private static void addSyntheticCases(List<Case> cases) {
+		Random rand = new Random(1);
+		int size = 4 << 20;
+		
+		// Incompressible data, which the compressor emits as stored blocks
+		byte[] random = new byte[size];
+		rand.nextBytes(random);
+		cases.add(new Case("stored", compress(random, 0), random));
+		
+		// Text-like data with a shifting character set, which gives many dynamic Huffman blocks
+		byte[] text = new byte[size];
+		for (int i = 0; i < text.length; ) {
+			if (i >= 10 && rand.nextInt(3) == 0) {
+				int dist = rand.nextInt(Math.min(i, 30000)) + 1;
+				for (int end = Math.min(i + rand.nextInt(30) + 3, text.length); i < end; i++)
+					text[i] = text[i - dist];
+			} else {
+				text[i] = (byte)('a' + (i >>> 16) % 10 + rand.nextInt(16));
+				i++;
+			}
+		}
+		cases.add(new Case("dynamic", compress(text, Deflater.DEFAULT_COMPRESSION), text));
+		
+		// A repeated pattern with rare changes, which is mostly maximum-length matches
+		byte[] repeats = new byte[size];
+		for (int i = 0; i < repeats.length; i++)
+			repeats[i] = i < 1000 || rand.nextInt(5000) == 0 ? (byte)rand.nextInt(256) : repeats[i - 1000];
+		cases.add(new Case("long matches", compress(repeats, Deflater.BEST_COMPRESSION), repeats));
+		
+		// Many small messages, each a separate stream that is typically a single fixed Huffman block
+		List<byte[]> comps = new ArrayList<>();
+		List<byte[]> datas = new ArrayList<>();
+		for (int i = 0; i < 10000; i++) {
+			byte[] msg = String.format("{\"id\":%d,\"name\":\"item%d\",\"tags\":[\"a\",\"b\"],\"value\":%d}",
+				i, rand.nextInt(1000), rand.nextInt()).getBytes(StandardCharsets.US_ASCII);
+			datas.add(msg);
+			comps.add(compress(msg, Deflater.DEFAULT_COMPRESSION));
+		}
+		cases.add(new Case("tiny (fixed)", comps, datas));
+	}
+	
+	
+	private static void addFileCases(File file, List<Case> cases) throws IOException {
+		if (file.isDirectory()) {
+			File[] children = file.listFiles();
+			Arrays.sort(children);
+			for (File child : children) {
+				if (child.isFile())
+					addFileCases(child, cases);
+			}
+		} else {
+			byte[] data = Files.readAllBytes(file.toPath());
+			cases.add(new Case(file.getName(), compress(data, Deflater.DEFAULT_COMPRESSION), data));
+		}
+	}
+	
+	
+	// Returns the raw DEFLATE compression of the given data at the given level.
+	private static byte[] compress(byte[] data, int level) {
+		Deflater def = new Deflater(level, true);
+		def.setInput(data);
+		def.finish();
+		ByteArrayOutputStream bout = new ByteArrayOutputStream();
+		byte[] buf = new byte[64 * 1024];
+		while (!def.finished())
+			bout.write(buf, 0, def.deflate(buf));
+		def.end();
+		return bout.toByteArray();
+	}
+	
+	
+	// A list of independent raw DEFLATE streams, and their decompressed data.
+	private static final class Case {
+		
+		public final String name;
+		public final byte[][] payloads;
+		public final long uncompressedSize;
+		public final int maxUncompressedSize;
+		public final byte[] lastPayload;  // The decompressed data of the last stream
+		
+		
+		public Case(String name, byte[] comp, byte[] data) {
+			this(name, Arrays.asList(comp), Arrays.asList(data));
+		}
+		
+		
+		public Case(String name, List<byte[]> comps, List<byte[]> datas) {
+			this.name = name;
+			payloads = comps.toArray(new byte[0][]);
+			long total = 0;
+			int max = 0;
+			for (byte[] b : datas) {
+				total += b.length;
+				max = Math.max(b.length, max);
+			}
+			uncompressedSize = total;
+			maxUncompressedSize = max;
+			lastPayload = datas.get(datas.size() - 1);
+		}
+		
+	}
+	
+	
+	
+	/*---- Decompression methods ----*/
+	
+	private static abstract class Method {
+		
+		public final String name;
+		
+		// When checking is set, run() saves the decompressed data of the case's last stream in lastOutput.
+		public boolean checking;
+		public byte[] lastOutput;
+		
+		
+		public Method(String name) {
+			this.name = name;
+		}
+		
+		
+		// Decompresses every stream of the case once.
+		public abstract void run(Case c) throws IOException, DataFormatException;
+		
+	}
+	
+	
+	// Discards everything written to it.
+	private static final OutputStream NULL_OUTPUT = new OutputStream() {
+		public void write(int b) {}
+		public void write(byte[] b, int off, int len) {}
+	};
+	
+	
+	private static final Method[] METHODS = {
+		new Method("Decompressor byte[]") {
+			public void run(Case c) throws IOException, DataFormatException {
+				for (byte[] p : c.payloads)
+					lastOutput = Decompressor.decompress(ByteBuffer.wrap(p));  // No extra allocation
+			}
+		},
+		
+		new Method("Decompressor stream") {
+			public void run(Case c) throws IOException, DataFormatException {
+				ByteArrayOutputStream bout = null;
+				for (byte[] p : c.payloads) {
+					OutputStream out = NULL_OUTPUT;
+					if (checking)
+						out = bout = new ByteArrayOutputStream();
+					Decompressor.decompress(new BufferedBitInputStream(new ByteArrayInputStream(p)), out);
+				}
+				if (checking)
+					lastOutput = bout.toByteArray();
+			}
+		},
+		
+		new Method("DecompressorPool") {
+			private DecompressorPool pool = new DecompressorPool(1);
+			private byte[] buffer = new byte[0];
+			
+			public void run(Case c) throws IOException, DataFormatException {
+				if (buffer.length < c.maxUncompressedSize)
+					buffer = new byte[c.maxUncompressedSize];
+				int n = 0;
+				for (byte[] p : c.payloads)
+					n = pool.decompress(p, 0, p.length, buffer, 0, buffer.length);
+				if (checking)
+					lastOutput = Arrays.copyOf(buffer, n);
+			}
+		},
+		
+		new Method("BatchDecompressor") {
+			public void run(Case c) throws IOException, DataFormatException {
+				int[] lengths = new int[c.payloads.length];
+				for (int i = 0; i < lengths.length; i++)
+					lengths[i] = c.payloads[i].length;
+				BatchDecompressor.Result r = BatchDecompressor.decompress(c.payloads, new int[lengths.length], lengths);
+				if (checking) {
+					int last = lengths.length - 1;
+					lastOutput = Arrays.copyOfRange(r.data, r.offsets[last], r.offsets[last + 1]);
+				}
+			}
+		},
+		
+		new Method("java.util.zip.Inflater") {
+			private Inflater inf = new Inflater(true);
+			private byte[] buffer = new byte[0];
+			
+			public void run(Case c) throws DataFormatException {
+				if (buffer.length < c.maxUncompressedSize)
+					buffer = new byte[c.maxUncompressedSize];
+				int n = 0;
+				for (byte[] p : c.payloads) {
+					inf.reset();
+					inf.setInput(p);
+					n = inf.inflate(buffer);
+				}
+				if (checking)
+					lastOutput = Arrays.copyOf(buffer, n);
+			}
+		},
+	};
+	
+}
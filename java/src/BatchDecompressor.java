@@ -0,0 +1,243 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.io.EOFException;
+import java.io.IOException;
+import java.io.InterruptedIOException;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.util.ArrayList;
+import java.util.List;
+import java.util.Objects;
+import java.util.concurrent.Callable;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.ForkJoinPool;
+import java.util.concurrent.Future;
+import java.util.zip.DataFormatException;
+
+
+/**
+ * Decompresses batches of many small raw DEFLATE streams, such as messages from a broker, into one
+ * contiguous output array. Each stream is given as a range of an array, where any number of streams can
+ * share an array. The whole batch is decoded by one decompressor with one bit input stream and one output
+ * window, so the cost per stream is only that of reading its blocks; no objects are created per stream.
+ * A batch can optionally be split into parts that are decoded in parallel on a fork-join pool.
+ */
+public final class BatchDecompressor {
+	
+	/*---- Public functions ----*/
+	
+	/**
+	 * Decompresses each of the specified raw DEFLATE streams on the current thread. Stream i is the range of
+	 * {@code lengths[i]} bytes of {@code buffers[i]} starting at index {@code offsets[i]}; bytes in the range
+	 * after the end of the DEFLATE data are ignored. The input arrays are not modified.
+	 * @param buffers the arrays holding the streams (not {@code null}, and no element is {@code null})
+	 * @param offsets the index of each stream's first byte (not {@code null})
+	 * @param lengths the number of bytes available to each stream (not {@code null})
+	 * @return the decompressed data of all the streams back to back, and where each one starts (not {@code null})
+	 * @throws NullPointerException if an array or buffer is {@code null}
+	 * @throws IllegalArgumentException if the three arrays differ in length
+	 * @throws IndexOutOfBoundsException if a stream's range is out of bounds
+	 * @throws EOFException if a range ends before its DEFLATE data does
+	 * @throws DataFormatException if a stream's DEFLATE data is malformed
+	 */
+	public static Result decompress(byte[][] buffers, int[] offsets, int[] lengths) throws IOException, DataFormatException {
+		checkArguments(buffers, offsets, lengths);
+		return decompressRange(buffers, offsets, lengths, 0, buffers.length);
+	}
+	
+	
+	/**
+	 * Decompresses each of the specified raw DEFLATE streams like {@link #decompress(byte[][], int[], int[])},
+	 * but splits the batch into consecutive parts that are decoded on the specified pool. Each part has its own
+	 * decoder state and output array, and the outputs are joined in order at the end (so this copies the output
+	 * once more). Batches too small to be worth splitting are decoded on the current thread.
+	 * @param buffers the arrays holding the streams (not {@code null}, and no element is {@code null})
+	 * @param offsets the index of each stream's first byte (not {@code null})
+	 * @param lengths the number of bytes available to each stream (not {@code null})
+	 * @param pool the pool to decode the parts on (not {@code null})
+	 * @return the decompressed data of all the streams back to back, and where each one starts (not {@code null})
+	 * @throws NullPointerException if an array, buffer, or the pool is {@code null}
+	 * @throws IllegalArgumentException if the three arrays differ in length
+	 * @throws IndexOutOfBoundsException if a stream's range is out of bounds
+	 * @throws EOFException if a range ends before its DEFLATE data does
+	 * @throws DataFormatException if a stream's DEFLATE data is malformed
+	 * @throws InterruptedIOException if the current thread is interrupted while waiting for the parts
+	 */
+	public static Result decompress(final byte[][] buffers, final int[] offsets, final int[] lengths, ForkJoinPool pool) throws IOException, DataFormatException {
+		checkArguments(buffers, offsets, lengths);
+		Objects.requireNonNull(pool);
+		int numParts = Math.min(buffers.length / MIN_PART_STREAMS, pool.getParallelism() * 4);
+		if (numParts <= 1)
+			return decompressRange(buffers, offsets, lengths, 0, buffers.length);
+		
+		// Each task returns its checked exception instead of throwing it, because depending on the JDK
+		// version and the calling thread, a fork-join pool wraps such an exception in a RuntimeException
+		List<Future<Object>> parts = new ArrayList<>();
+		for (int i = 0; i < numParts; i++) {
+			final int from = (int)((long)buffers.length * i / numParts);
+			final int to = (int)((long)buffers.length * (i + 1) / numParts);
+			parts.add(pool.submit(new Callable<Object>() {
+				public Object call() {
+					try {
+						return decompressRange(buffers, offsets, lengths, from, to);
+					} catch (IOException|DataFormatException e) {
+						return e;
+					}
+				}
+			}));
+		}
+		
+		// Join the parts' outputs, rebasing their offsets
+		try {
+			Result[] results = new Result[numParts];
+			long totalLength = 0;
+			for (int i = 0; i < numParts; i++) {
+				results[i] = getResult(parts.get(i));
+				totalLength += results[i].data.length;
+			}
+			if (totalLength > Integer.MAX_VALUE - 8)
+				throw new OutOfMemoryError("Output exceeds maximum array size");
+			byte[] data = new byte[(int)totalLength];
+			int[] outOffsets = new int[buffers.length + 1];
+			int stream = 0;
+			int pos = 0;
+			for (Result r : results) {
+				System.arraycopy(r.data, 0, data, pos, r.data.length);
+				for (int i = 1; i < r.offsets.length; i++)
+					outOffsets[stream + i] = pos + r.offsets[i];
+				stream += r.offsets.length - 1;
+				pos += r.data.length;
+			}
+			return new Result(data, outOffsets);
+		} finally {
+			for (Future<Object> f : parts)
+				f.cancel(false);
+		}
+	}
+	
+	
+	
+	/*---- Result class ----*/
+	
+	/**
+	 * The decompressed data of a batch of streams. The output of stream i is the range of {@code data} from
+	 * index {@code offsets[i]} (inclusive) to {@code offsets[i + 1]} (exclusive). Treat the arrays as read-only.
+	 */
+	public static final class Result {
+		
+		/** The outputs of all the streams, in order and back to back (not {@code null}). */
+		public final byte[] data;
+		
+		/** The start index of each stream's output, followed by the total length; so there is one more element than streams (not {@code null}). */
+		public final int[] offsets;
+		
+		
+		private Result(byte[] data, int[] offsets) {
+			this.data = data;
+			this.offsets = offsets;
+		}
+		
+		
+		/**
+		 * Returns the length of the specified stream's output.
+		 * @param index the index of the stream
+		 * @return the number of decompressed bytes of the stream
+		 * @throws IndexOutOfBoundsException if the index is out of bounds
+		 */
+		public int length(int index) {
+			if (index < 0 || index >= offsets.length - 1)
+				throw new IndexOutOfBoundsException();
+			return offsets[index + 1] - offsets[index];
+		}
+		
+	}
+	
+	
+	
+	/*---- Private implementation ----*/
+	
+	private static void checkArguments(byte[][] buffers, int[] offsets, int[] lengths) {
+		Objects.requireNonNull(buffers);
+		Objects.requireNonNull(offsets);
+		Objects.requireNonNull(lengths);
+		if (offsets.length != buffers.length || lengths.length != buffers.length)
+			throw new IllegalArgumentException("Array lengths differ");
+		for (int i = 0; i < buffers.length; i++) {
+			if (offsets[i] < 0 || lengths[i] < 0 || offsets[i] > buffers[i].length - lengths[i])
+				throw new IndexOutOfBoundsException("Stream " + i);
+		}
+	}
+	
+	
+	// Decodes the streams with indexes in [from, to) back to back into one output window, reusing one
+	// decompressor and one bit input stream. Consecutive streams in the same array share one buffer view.
+	private static Result decompressRange(byte[][] buffers, int[] offsets, int[] lengths, int from, int to) throws IOException, DataFormatException {
+		long inputLength = 0;
+		for (int i = from; i < to; i++)
+			inputLength += lengths[i];
+		ByteArrayOutputWindow out = new ByteArrayOutputWindow((int)Math.max(Math.min(inputLength * 4, MAX_INITIAL_OUTPUT), 1024));
+		Decompressor decomp = new Decompressor(out);
+		ByteBufferBitInputStream in = new ByteBufferBitInputStream(EMPTY_BUFFER);
+		int[] outOffsets = new int[to - from + 1];
+		byte[] array = null;
+		ByteBuffer view = null;
+		for (int i = from; i < to; i++) {
+			if (buffers[i] != array) {
+				array = buffers[i];
+				view = ByteBuffer.wrap(array).order(ByteOrder.LITTLE_ENDIAN);
+			}
+			in.reset(view, offsets[i], offsets[i] + lengths[i]);
+			out.startStream();
+			try {
+				decomp.decompressStream(in);
+			} catch (EOFException e) {
+				EOFException ex = new EOFException("Stream " + i + " is truncated");
+				ex.initCause(e);
+				throw ex;
+			} catch (DataFormatException e) {
+				throw new DataFormatException("Stream " + i + ": " + e.getMessage());
+			}
+			outOffsets[i - from + 1] = out.length();
+		}
+		return new Result(out.toByteArray(), outOffsets);
+	}
+	
+	
+	// Waits for the given part and returns its result, rethrowing any exception it returned or threw.
+	private static Result getResult(Future<Object> future) throws IOException, DataFormatException {
+		Object result;
+		try {
+			result = future.get();
+		} catch (InterruptedException e) {
+			Thread.currentThread().interrupt();
+			throw new InterruptedIOException();
+		} catch (ExecutionException e) {
+			Throwable cause = e.getCause();
+			if (cause instanceof RuntimeException)
+				throw (RuntimeException)cause;
+			throw (Error)cause;
+		}
+		if (result instanceof IOException)
+			throw (IOException)result;
+		if (result instanceof DataFormatException)
+			throw (DataFormatException)result;
+		return (Result)result;
+	}
+	
+	
+	// The fewest streams in a part when a batch is split, so that each task has enough work to be worth submitting.
+	private static final int MIN_PART_STREAMS = 256;
+	
+	// The most output space a part reserves before decoding, namely 1 MiB. The guess of 4 times the input is only
+	// a starting point, and the window doubles as needed, so a large part does not claim a huge array up front.
+	private static final int MAX_INITIAL_OUTPUT = 1 << 20;
+	
+	private static final ByteBuffer EMPTY_BUFFER = ByteBuffer.allocate(0);
+	
+}
@@ -0,0 +1,110 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+
+/**
+ * The decoding tables of a dynamic Huffman block's literal/length code and distance code, fused into one
+ * compact array for the decoding loop. Each entry already holds the value its symbol stands for, so a
+ * symbol costs one dependent load (two for a code longer than the primary table), and the whole array
+ * is small enough to stay in the L1 cache. This data structure is immutable.
+ */
+final class BlockDecodeTable {
+	
+	/* 
+	 * The array is laid out as follows, where each table is indexed by upcoming bits of the stream
+	 * and has subtables for long codes like the decode table of CanonicalCode:
+	 * - [0, 2 << litLenBits): For each index i of the literal/length primary table, the literal pair
+	 *   entry at 2i (as in CanonicalCode.lookupLiteralPair(), zero if none) and the symbol entry at 2i + 1.
+	 *   Interleaving them puts the two loads that a symbol starts with in the same cache line.
+	 * - [2 << litLenBits, distStart): The literal/length subtables.
+	 * - [distStart, table.length): The distance primary table followed by its subtables.
+	 * 
+	 * A symbol entry packs (value << 16) | (kind << 8) | (numExtraBits << 4) | codeLength in the format of
+	 * the fused tables in Decompressor, where the code length is in [1, 15]. A link entry has code length 0
+	 * and packs (subtableIndex << 16) | (subtableBits << 4), where the subtable index is absolute in the array.
+	 */
+	final int[] table;
+	
+	// Number of index bits in the literal/length primary table.
+	final int litLenBits;
+	
+	// Index of the distance primary table in the array.
+	final int distStart;
+	
+	// Number of index bits in the distance primary table.
+	final int distBits;
+	
+	
+	
+	/**
+	 * Constructs the fused tables for the specified pair of codes.
+	 * @param litLenCode the literal/length code, with at most 288 symbols (not {@code null})
+	 * @param distCode the distance code, with at most 32 symbols (not {@code null})
+	 * @throws NullPointerException if either code is {@code null}
+	 * @throws IllegalArgumentException if either alphabet is too large
+	 */
+	public BlockDecodeTable(CanonicalCode litLenCode, CanonicalCode distCode) {
+		if (litLenCode.getSymbolLimit() > 288 || litLenCode.getSymbolLimit() <= 256 || distCode.getSymbolLimit() > 32)
+			throw new IllegalArgumentException("Invalid alphabet size");
+		litLenBits = litLenCode.getPrimaryBits();
+		distBits = distCode.getPrimaryBits();
+		int litLenPrimarySize = 1 << litLenBits;
+		int litLenSubtableStart = 2 << litLenBits;
+		distStart = litLenSubtableStart + litLenCode.getTableSize() - litLenPrimarySize;
+		table = new int[distStart + distCode.getTableSize()];
+		if (table.length > 1 << 16)
+			throw new AssertionError("Table too large for the entry format");
+		
+		// Literal/length subtables move from right after the primary table to after the interleaved entries
+		int shift = litLenSubtableStart - litLenPrimarySize;
+		for (int i = 0; i < litLenPrimarySize; i++) {
+			table[i * 2] = litLenCode.lookupLiteralPair(i);
+			table[i * 2 + 1] = translateLiteralLength(litLenCode.getTableEntry(i), shift);
+		}
+		for (int i = litLenPrimarySize; i < litLenCode.getTableSize(); i++)
+			table[i + shift] = translateLiteralLength(litLenCode.getTableEntry(i), shift);
+		for (int i = 0; i < distCode.getTableSize(); i++)
+			table[distStart + i] = translateDistance(distCode.getTableEntry(i), distStart);
+	}
+	
+	
+	// Converts the given literal/length entry of a CanonicalCode decode table, where the given
+	// shift is added to the index of a subtable.
+	private static int translateLiteralLength(int entry, int shift) {
+		int len = entry & 0xF;
+		if (len == 0)
+			return translateLink(entry, shift);
+		int sym = entry >>> 4;
+		int info;
+		if (sym < 256)
+			info = sym << 16 | Decompressor.KIND_LITERAL << 8;
+		else if (sym == 256)
+			info = Decompressor.KIND_END_OF_BLOCK << 8;
+		else
+			info = Decompressor.LENGTH_SYMBOL_TABLE[sym - 257];
+		return info | len;
+	}
+	
+	
+	// Converts the given distance entry of a CanonicalCode decode table, where the given
+	// shift is added to the index of a subtable.
+	private static int translateDistance(int entry, int shift) {
+		int len = entry & 0xF;
+		if (len == 0)
+			return translateLink(entry, shift);
+		return Decompressor.DISTANCE_SYMBOL_TABLE[entry >>> 4] | len;
+	}
+	
+	
+	private static int translateLink(int entry, int shift) {
+		int subtableBits = (entry >>> 4) & 0xF;
+		int subtableOffset = entry >>> 8;
+		return (subtableOffset + shift) << 16 | subtableBits << 4;
+	}
+	
+}
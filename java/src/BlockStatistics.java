@@ -0,0 +1,70 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.util.Arrays;
+
+
+/**
+ * Statistics about one decoded DEFLATE block, as reported to a {@link DecompressorListener}.
+ * The fields are only meaningful while the listener is being called. Mutable and not thread-safe.
+ */
+public final class BlockStatistics {
+	
+	/*---- Fields ----*/
+	
+	/** The block type: 0 for uncompressed, 1 for fixed Huffman codes, 2 for dynamic Huffman codes. */
+	public int blockType;
+	
+	/** The number of input bits taken by the block, from its 3-bit header through its end
+	 * (including any padding before an uncompressed block's length fields). */
+	public long compressedBits;
+	
+	/** The number of input bits taken by a dynamic block's code definitions, otherwise 0. */
+	public long headerBits;
+	
+	/** The number of bytes of output that the block produced. */
+	public long uncompressedBytes;
+	
+	/** The number of literal symbols in a Huffman-coded block. */
+	public long literalCount;
+	
+	/** The number of length-distance pairs in a Huffman-coded block. */
+	public long matchCount;
+	
+	/** The number of matches of each length, indexed by the length in the range [3, 258]. */
+	public final long[] matchLengthHistogram = new long[259];
+	
+	/** The number of matches with each distance symbol, in the range [0, 29]
+	 * (see RFC 1951 section 3.2.5 for the distances that each symbol covers). */
+	public final long[] distanceSymbolHistogram = new long[30];
+	
+	/** The nanoseconds spent reading a dynamic block's code definitions and building its codes. */
+	public long headerNanos;
+	
+	/** The nanoseconds spent decoding the block's data after its header. */
+	public long bodyNanos;
+	
+	
+	
+	/*---- Methods ----*/
+	
+	// Resets every field to zero, for the next block.
+	void clear() {
+		blockType = 0;
+		compressedBits = 0;
+		headerBits = 0;
+		uncompressedBytes = 0;
+		literalCount = 0;
+		matchCount = 0;
+		Arrays.fill(matchLengthHistogram, 0);
+		Arrays.fill(distanceSymbolHistogram, 0);
+		headerNanos = 0;
+		bodyNanos = 0;
+	}
+	
+}
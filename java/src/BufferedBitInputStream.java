@@ -0,0 +1,227 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.io.EOFException;
+import java.io.IOException;
+import java.io.InputStream;
+import java.util.Objects;
+
+
+/**
+ * A stream of bits that reads the underlying byte stream in blocks and keeps up to 64 upcoming
+ * bits in an accumulator, so that many bits can be peeked or read in one call. The total number of
+ * bits is always a multiple of 8, and the bits are read in little endian. Because of the read-ahead,
+ * the underlying stream is generally positioned past the bits that have been read, so any data that
+ * follows the bit stream must be read through {@link #readByte()} of this object. Mutable and not thread-safe.
+ */
+public final class BufferedBitInputStream implements PeekableBitInputStream {
+	
+	/*---- Fields ----*/
+	
+	// The underlying byte stream to read from (not null).
+	private InputStream input;
+	
+	// Block of bytes read from the underlying stream; the bytes in [bufferIndex, bufferLength) are yet to be used.
+	private byte[] buffer;
+	private int bufferIndex;
+	private int bufferLength;
+	
+	// Whether the underlying stream has reported its end (or this stream has been closed).
+	private boolean isEndOfInput;
+	
+	// Upcoming bits of the stream, with the next bit in the least significant position.
+	// Bits at and above position bitBufferLength are always zero.
+	private long bitBuffer;
+	
+	// Number of valid bits in bitBuffer, always between 0 and 64 (inclusive).
+	private int bitBufferLength;
+	
+	
+	
+	/*---- Constructors ----*/
+	
+	/**
+	 * Constructs a bit input stream based on the specified byte input stream, with a default buffer size.
+	 * @param in the byte input stream (not {@code null})
+	 * @throws NullPointerException if the input stream is {@code null}
+	 */
+	public BufferedBitInputStream(InputStream in) {
+		this(in, 16 * 1024);
+	}
+	
+	
+	/**
+	 * Constructs a bit input stream based on the specified byte input stream and buffer size.
+	 * @param in the byte input stream (not {@code null})
+	 * @param bufferSize the number of bytes to read from the underlying stream at a time, which must be positive
+	 * @throws NullPointerException if the input stream is {@code null}
+	 * @throws IllegalArgumentException if the buffer size is zero or negative
+	 */
+	public BufferedBitInputStream(InputStream in, int bufferSize) {
+		input = Objects.requireNonNull(in);
+		if (bufferSize < 1)
+			throw new IllegalArgumentException("Buffer size must be positive");
+		buffer = new byte[bufferSize];
+		bufferIndex = 0;
+		bufferLength = 0;
+		isEndOfInput = false;
+		bitBuffer = 0;
+		bitBufferLength = 0;
+	}
+	
+	
+	
+	/*---- Methods ----*/
+	
+	public int getBitPosition() {
+		// The bit buffer is only ever filled with whole bytes
+		return -bitBufferLength & 7;
+	}
+	
+	
+	public int readByte() throws IOException {
+		// Discard the remainder of the current byte
+		int skip = bitBufferLength & 7;
+		bitBuffer >>>= skip;
+		bitBufferLength -= skip;
+		
+		if (bitBufferLength == 0) {
+			refill();
+			if (bitBufferLength == 0)
+				return -1;
+		}
+		int result = (int)bitBuffer & 0xFF;
+		bitBuffer >>>= 8;
+		bitBufferLength -= 8;
+		return result;
+	}
+	
+	
+	public int read() throws IOException {
+		if (bitBufferLength == 0) {
+			refill();
+			if (bitBufferLength == 0)
+				return -1;
+		}
+		int result = (int)bitBuffer & 1;
+		bitBuffer >>>= 1;
+		bitBufferLength--;
+		return result;
+	}
+	
+	
+	public int readNoEof() throws IOException {
+		int result = read();
+		if (result == -1)
+			throw new EOFException();
+		return result;
+	}
+	
+	
+	public int peekBits(int numBits) throws IOException {
+		if (numBits < 0 || numBits > 32)
+			throw new IllegalArgumentException();
+		if (bitBufferLength < numBits)
+			refill();
+		return (int)(bitBuffer & ((1L << numBits) - 1));
+	}
+	
+	
+	public void consumeBits(int numBits) throws IOException {
+		if (numBits < 0 || numBits > 32)
+			throw new IllegalArgumentException();
+		if (bitBufferLength < numBits) {
+			refill();
+			if (bitBufferLength < numBits)
+				throw new EOFException();
+		}
+		bitBuffer >>>= numBits;
+		bitBufferLength -= numBits;
+	}
+	
+	
+	public int readBits(int numBits) throws IOException {
+		int result = peekBits(numBits);
+		consumeBits(numBits);
+		return result;
+	}
+	
+	
+	public int readBytes(byte[] b, int off, int len) throws IOException {
+		Objects.requireNonNull(b);
+		if (off < 0 || len < 0 || off > b.length - len)
+			throw new IndexOutOfBoundsException();
+		
+		// Discard the remainder of the current byte, then take the whole bytes in the bit buffer
+		int skip = bitBufferLength & 7;
+		bitBuffer >>>= skip;
+		bitBufferLength -= skip;
+		int count = 0;
+		for (; count < len && bitBufferLength > 0; count++) {
+			b[off + count] = (byte)bitBuffer;
+			bitBuffer >>>= 8;
+			bitBufferLength -= 8;
+		}
+		
+		// Copy from the block buffer, and read long runs straight from the underlying stream
+		while (count < len && !(bufferIndex == bufferLength && isEndOfInput)) {
+			if (bufferIndex < bufferLength) {
+				int n = Math.min(len - count, bufferLength - bufferIndex);
+				System.arraycopy(buffer, bufferIndex, b, off + count, n);
+				bufferIndex += n;
+				count += n;
+			} else {
+				boolean direct = len - count >= buffer.length;
+				int n = direct ? input.read(b, off + count, len - count) : input.read(buffer);
+				if (n == -1)
+					isEndOfInput = true;
+				else if (direct)
+					count += n;
+				else {
+					bufferIndex = 0;
+					bufferLength = n;
+				}
+			}
+		}
+		return count;
+	}
+	
+	
+	public void close() throws IOException {
+		input.close();
+		bufferIndex = 0;
+		bufferLength = 0;
+		isEndOfInput = true;
+		bitBuffer = 0;
+		bitBufferLength = 0;
+	}
+	
+	
+	// Moves whole bytes from the block buffer into the bit buffer until
+	// it holds more than 56 bits or the underlying stream has ended.
+	private void refill() throws IOException {
+		while (bitBufferLength <= 56) {
+			if (bufferIndex == bufferLength) {
+				if (isEndOfInput)
+					break;
+				int n = input.read(buffer);
+				if (n == -1) {
+					isEndOfInput = true;
+					break;
+				}
+				bufferIndex = 0;
+				bufferLength = n;
+			} else {
+				bitBuffer |= (buffer[bufferIndex] & 0xFFL) << bitBufferLength;
+				bufferIndex++;
+				bitBufferLength += 8;
+			}
+		}
+	}
+	
+}
@@ -0,0 +1,149 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.io.IOException;
+import java.util.Arrays;
+
+
+/**
+ * An output window that accumulates the entire output in a growable byte array,
+ * which also serves as the history for back-references. So unlike an output stream
+ * paired with a byte history, each byte is written only once. Mutable and not thread-safe.
+ */
+final class ByteArrayOutputWindow implements OutputWindow {
+	
+	/*---- Fields ----*/
+	
+	// The output data is in the range [0, length), and the rest of the array is unused.
+	private byte[] data;
+	
+	private int length;
+	
+	// Index where the current stream's output begins. Back-references cannot reach
+	// the bytes before it (which belong to earlier streams), so they read as zeros.
+	private int streamStart;
+	
+	
+	
+	/*---- Constructor ----*/
+	
+	/**
+	 * Constructs an empty output window with a small initial capacity.
+	 */
+	public ByteArrayOutputWindow() {
+		this(1024);
+	}
+	
+	
+	/**
+	 * Constructs an empty output window with the specified initial capacity.
+	 * @param initialCapacity the initial capacity in bytes, which must be positive
+	 * @throws IllegalArgumentException if the capacity is not positive
+	 */
+	public ByteArrayOutputWindow(int initialCapacity) {
+		if (initialCapacity < 1)
+			throw new IllegalArgumentException("Capacity must be positive");
+		data = new byte[initialCapacity];
+		length = 0;
+		streamStart = 0;
+	}
+	
+	
+	
+	/*---- Methods ----*/
+	
+	public void append(int b) {
+		if (length == data.length)
+			ensureCapacity(1);
+		data[length] = (byte)b;
+		length++;
+	}
+	
+	
+	public void append(byte[] b, int off, int len) {
+		ensureCapacity(len);
+		System.arraycopy(b, off, data, length, len);
+		length += len;
+	}
+	
+	
+	public int appendFrom(PeekableBitInputStream in, int len) throws IOException {
+		if (len < 0)
+			throw new IllegalArgumentException();
+		ensureCapacity(len);
+		int n = in.readBytes(data, length, len);  // Straight into the output array
+		length += n;
+		return n;
+	}
+	
+	
+	public void copy(int dist, int len) {
+		if (len < 0 || dist < 1)
+			throw new IllegalArgumentException();
+		ensureCapacity(len);
+		int readIndex = length - dist;
+		if (readIndex < streamStart) {
+			// Rare case where the copy starts before the beginning of the output
+			for (int i = 0; i < len; i++, readIndex++)
+				data[length + i] = readIndex < streamStart ? 0 : data[readIndex];
+		} else if (dist >= len)
+			System.arraycopy(data, readIndex, data, length, len);
+		else {
+			// The output is the dist bytes before the end repeated,
+			// so copy the pattern, doubling the amount available each time
+			for (int copied = 0; copied < len; ) {
+				int n = Math.min(len - copied, dist + copied);
+				System.arraycopy(data, readIndex, data, length + copied, n);
+				copied += n;
+			}
+		}
+		length += len;
+	}
+	
+	
+	/**
+	 * Starts a new stream at the current end of the output, so that later back-references cannot reach the bytes
+	 * appended so far. This lets one window hold the outputs of many independent streams back to back.
+	 */
+	public void startStream() {
+		streamStart = length;
+	}
+	
+	
+	/**
+	 * Returns the number of bytes appended so far.
+	 * @return the output length
+	 */
+	public int length() {
+		return length;
+	}
+	
+	
+	/**
+	 * Returns a new array containing all the bytes appended so far.
+	 * @return a copy of the output data
+	 */
+	public byte[] toByteArray() {
+		return Arrays.copyOf(data, length);
+	}
+	
+	
+	// Grows the array if needed so that at least n more bytes fit.
+	private void ensureCapacity(int n) {
+		if (data.length - length >= n)
+			return;
+		long newCapacity = Math.max((long)length + n, data.length * 2L);
+		if (newCapacity > Integer.MAX_VALUE - 8) {
+			if ((long)length + n > Integer.MAX_VALUE - 8)
+				throw new OutOfMemoryError("Output exceeds maximum array size");
+			newCapacity = Integer.MAX_VALUE - 8;
+		}
+		data = Arrays.copyOf(data, (int)newCapacity);
+	}
+	
+}
@@ -0,0 +1,241 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.io.EOFException;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+
+
+/**
+ * A stream of bits read in place from the remaining bytes of a byte buffer, which can be heap,
+ * direct, or memory-mapped. No bytes are copied out of the buffer except into a 64-bit accumulator
+ * of upcoming bits. The total number of bits is always a multiple of 8, and the bits are read in
+ * little endian. The buffer's own position is not changed. Mutable and not thread-safe.
+ */
+public final class ByteBufferBitInputStream implements PeekableBitInputStream {
+	
+	/*---- Fields ----*/
+	
+	// A little-endian view of the caller's buffer (not null), sharing its content.
+	private ByteBuffer buffer;
+	
+	// Index of the next byte to move into the bit buffer, in the range [start position, limit].
+	private int index;
+	
+	// The limit of the buffer, where the stream ends.
+	private int limit;
+	
+	// Upcoming bits of the stream, with the next bit in the least significant position.
+	// Bits at and above position bitBufferLength are always zero.
+	private long bitBuffer;
+	
+	// Number of valid bits in bitBuffer, always between 0 and 64 (inclusive).
+	private int bitBufferLength;
+	
+	
+	
+	/*---- Constructor ----*/
+	
+	/**
+	 * Constructs a bit input stream that reads the bytes of the specified buffer from its current position to its limit.
+	 * @param buf the byte buffer to read (not {@code null})
+	 * @throws NullPointerException if the buffer is {@code null}
+	 */
+	public ByteBufferBitInputStream(ByteBuffer buf) {
+		buffer = buf.duplicate().order(ByteOrder.LITTLE_ENDIAN);
+		index = buf.position();
+		limit = buf.limit();
+		bitBuffer = 0;
+		bitBufferLength = 0;
+	}
+	
+	
+	
+	// Returns a stream over the given buffer (up to its limit) whose next bit is at the given bit offset, which is counted
+	// from index 0 of the buffer as with getBitOffset(). Throws EOFException if the offset is beyond the limit.
+	static ByteBufferBitInputStream openAtBitOffset(ByteBuffer buf, long bitOffset) throws EOFException {
+		if (bitOffset < 0)
+			throw new IllegalArgumentException();
+		if (bitOffset > buf.limit() * 8L)
+			throw new EOFException();
+		ByteBuffer b = buf.duplicate();
+		b.position((int)(bitOffset >>> 3));
+		ByteBufferBitInputStream result = new ByteBufferBitInputStream(b);
+		result.consumeBits((int)bitOffset & 7);
+		return result;
+	}
+	
+	
+	
+	// Makes this stream read the given buffer's bytes in the range [start, end) from the beginning, as if newly constructed but
+	// without allocating. The buffer must be little-endian and is used as is, not duplicated, so all of its users must only
+	// use absolute indexes. This lets one instance decode many small streams that lie in the same array.
+	void reset(ByteBuffer buf, int start, int end) {
+		if (buf.order() != ByteOrder.LITTLE_ENDIAN)
+			throw new IllegalArgumentException();
+		if (start < 0 || start > end || end > buf.limit())
+			throw new IndexOutOfBoundsException();
+		buffer = buf;
+		index = start;
+		limit = end;
+		bitBuffer = 0;
+		bitBufferLength = 0;
+	}
+	
+	
+	
+	/*---- Methods ----*/
+	
+	/**
+	 * Returns the buffer index where byte-aligned data following the bits read so far begins.
+	 * A partially read byte counts as read, so after decompressing a DEFLATE stream this is
+	 * the index of the first byte after the stream (e.g. the start of a gzip footer).
+	 * @return the index of the first byte after the bits read so far
+	 */
+	public int getPosition() {
+		return index - (bitBufferLength >>> 3);
+	}
+	
+	
+	/**
+	 * Returns the offset of the next bit to read, counted in bits from the start of the buffer
+	 * (i.e. 8 times the byte index, plus the number of bits already read from that byte).
+	 * @return the bit offset of the next bit in the buffer
+	 */
+	public long getBitOffset() {
+		return (long)index * 8 - bitBufferLength;
+	}
+	
+	
+	public int getBitPosition() {
+		// The bit buffer is only ever filled with whole bytes
+		return -bitBufferLength & 7;
+	}
+	
+	
+	public int readByte() {
+		// Discard the remainder of the current byte
+		int skip = bitBufferLength & 7;
+		bitBuffer >>>= skip;
+		bitBufferLength -= skip;
+		
+		if (bitBufferLength == 0) {
+			if (index == limit)
+				return -1;
+			int result = buffer.get(index) & 0xFF;
+			index++;
+			return result;
+		}
+		int result = (int)bitBuffer & 0xFF;
+		bitBuffer >>>= 8;
+		bitBufferLength -= 8;
+		return result;
+	}
+	
+	
+	public int read() {
+		if (bitBufferLength == 0) {
+			refill();
+			if (bitBufferLength == 0)
+				return -1;
+		}
+		int result = (int)bitBuffer & 1;
+		bitBuffer >>>= 1;
+		bitBufferLength--;
+		return result;
+	}
+	
+	
+	public int readNoEof() throws EOFException {
+		int result = read();
+		if (result == -1)
+			throw new EOFException();
+		return result;
+	}
+	
+	
+	public int peekBits(int numBits) {
+		if (numBits < 0 || numBits > 32)
+			throw new IllegalArgumentException();
+		if (bitBufferLength < numBits)
+			refill();
+		return (int)(bitBuffer & ((1L << numBits) - 1));
+	}
+	
+	
+	public void consumeBits(int numBits) throws EOFException {
+		if (numBits < 0 || numBits > 32)
+			throw new IllegalArgumentException();
+		if (bitBufferLength < numBits) {
+			refill();
+			if (bitBufferLength < numBits)
+				throw new EOFException();
+		}
+		bitBuffer >>>= numBits;
+		bitBufferLength -= numBits;
+	}
+	
+	
+	public int readBits(int numBits) throws EOFException {
+		int result = peekBits(numBits);
+		consumeBits(numBits);
+		return result;
+	}
+	
+	
+	public int readBytes(byte[] b, int off, int len) {
+		if (off < 0 || len < 0 || off > b.length - len)
+			throw new IndexOutOfBoundsException();
+		
+		// Discard the remainder of the current byte, then take the whole bytes in the bit buffer
+		int skip = bitBufferLength & 7;
+		bitBuffer >>>= skip;
+		bitBufferLength -= skip;
+		int count = 0;
+		for (; count < len && bitBufferLength > 0; count++) {
+			b[off + count] = (byte)bitBuffer;
+			bitBuffer >>>= 8;
+			bitBufferLength -= 8;
+		}
+		
+		// Copy the rest straight out of the buffer in one bulk transfer; repositioning our
+		// private view is harmless because all other accesses use absolute indexes
+		int n = Math.min(len - count, limit - index);
+		buffer.position(index);
+		buffer.get(b, off + count, n);
+		index += n;
+		return count + n;
+	}
+	
+	
+	public void close() {
+		index = limit;
+		bitBuffer = 0;
+		bitBufferLength = 0;
+	}
+	
+	
+	// Moves as many whole bytes from the buffer into the bit buffer as fit.
+	private void refill() {
+		int numBytes = (64 - bitBufferLength) >>> 3;
+		if (limit - index >= 8) {
+			// Load 8 bytes in one access, and keep the ones that fit
+			long bits = buffer.getLong(index);
+			if (numBytes < 8)
+				bits &= (1L << (numBytes * 8)) - 1;
+			bitBuffer |= bits << bitBufferLength;
+		} else {
+			numBytes = Math.min(numBytes, limit - index);
+			for (int i = 0; i < numBytes; i++)
+				bitBuffer |= (buffer.get(index + i) & 0xFFL) << (bitBufferLength + i * 8);
+		}
+		index += numBytes;
+		bitBufferLength += numBytes * 8;
+	}
+	
+}
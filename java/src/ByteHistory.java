@@ -8,7 +8,9 @@
 
 import java.io.IOException;
 import java.io.OutputStream;
+import java.util.Arrays;
 import java.util.Objects;
+import java.util.zip.Checksum;
 
 
 /**
@@ -25,6 +27,10 @@ final class ByteHistory {
 	// Index of next byte to write to, always in the range [0, data.length).
 	private int index;
 	
+	// Whether the index has wrapped around since construction or the last reset,
+	// i.e. whether any bytes at or after the index may be nonzero.
+	private boolean hasWrapped;
+	
 	
 	
 	/*---- Constructor ----*/
@@ -39,6 +45,7 @@ final class ByteHistory {
 			throw new IllegalArgumentException("Size must be positive");
 		data = new byte[size];
 		index = 0;
+		hasWrapped = false;
 	}
 	
 	
@@ -54,7 +61,104 @@ final class ByteHistory {
 		if (index < 0 || index >= data.length)
 			throw new AssertionError();
 		data[index] = (byte)b;
-		index = (index + 1) % data.length;
+		index++;
+		if (index == data.length) {
+			index = 0;
+			hasWrapped = true;
+		}
+	}
+	
+	
+	/**
+	 * Appends the specified bytes to this history, with the same result as appending
+	 * them one at a time. Only the last {@code size} of them are actually copied.
+	 * @param b the array of bytes to append (not {@code null})
+	 * @param off the index of the first byte to append
+	 * @param len the number of bytes to append
+	 * @throws NullPointerException if the array is {@code null}
+	 * @throws IndexOutOfBoundsException if the array range is out of bounds
+	 */
+	public void append(byte[] b, int off, int len) {
+		if (off < 0 || len < 0 || off > b.length - len)
+			throw new IndexOutOfBoundsException();
+		if (len >= data.length) {
+			System.arraycopy(b, off + len - data.length, data, 0, data.length);
+			index = 0;
+			hasWrapped = true;
+		} else {
+			int n = Math.min(len, data.length - index);
+			System.arraycopy(b, off, data, index, n);
+			System.arraycopy(b, off + n, data, 0, len - n);
+			index += len;
+			if (index >= data.length) {
+				index -= data.length;
+				hasWrapped = true;
+			}
+		}
+	}
+	
+	
+	/**
+	 * Reads up to {@code len} whole bytes from the specified stream (after discarding the remainder of its
+	 * current byte) directly into this history, and also writes them to the specified output stream. This
+	 * moves the bytes without any intermediate buffer. Returns the number of bytes read and appended,
+	 * which is less than {@code len} only if the input stream ran out of bytes.
+	 * @param in the bit input stream to read from (not {@code null})
+	 * @param len the maximum number of bytes to read, which must be at least 0
+	 * @param out the output stream to write to (not {@code null})
+	 * @return the number of bytes appended
+	 * @throws IOException if an I/O exception occurred
+	 */
+	public int appendFrom(PeekableBitInputStream in, int len, OutputStream out) throws IOException {
+		return appendFromImpl(in, len, Objects.requireNonNull(out));
+	}
+	
+	
+	/**
+	 * Reads up to {@code len} whole bytes from the specified stream (after discarding the remainder of
+	 * its current byte) directly into this history, without writing them anywhere else. Returns the number
+	 * of bytes read and appended, which is less than {@code len} only if the input stream ran out of bytes.
+	 * @param in the bit input stream to read from (not {@code null})
+	 * @param len the maximum number of bytes to read, which must be at least 0
+	 * @return the number of bytes appended
+	 * @throws IOException if an I/O exception occurred
+	 */
+	public int appendFrom(PeekableBitInputStream in, int len) throws IOException {
+		return appendFromImpl(in, len, null);
+	}
+	
+	
+	// Implements both appendFrom() methods, where the output stream is null if there is none.
+	private int appendFromImpl(PeekableBitInputStream in, int len, OutputStream out) throws IOException {
+		if (len < 0)
+			throw new IllegalArgumentException();
+		int count = 0;
+		while (count < len) {
+			int n = Math.min(len - count, data.length - index);
+			int k = in.readBytes(data, index, n);
+			if (out != null)
+				out.write(data, index, k);
+			count += k;
+			index += k;
+			if (index == data.length) {
+				index = 0;
+				hasWrapped = true;
+			}
+			if (k < n)
+				break;
+		}
+		return count;
+	}
+	
+	
+	/**
+	 * Resets this history to all zeros, as if newly constructed. This only clears
+	 * the bytes that were written, so it is cheap if little was appended.
+	 */
+	public void reset() {
+		Arrays.fill(data, 0, hasWrapped ? data.length : index, (byte)0);
+		index = 0;
+		hasWrapped = false;
 	}
 	
 	
@@ -76,15 +180,172 @@ final class ByteHistory {
 		if (len < 0 || dist < 1 || dist > data.length)
 			throw new IllegalArgumentException();
 		
-		int readIndex = (index - dist + data.length) % data.length;
+		// Copy in pieces no longer than the buffer, so that each piece
+		// is still intact in the buffer when it is written to the output
+		while (len > 0) {
+			int n = Math.min(len, data.length);
+			int start = index;
+			copyWithinBuffer(dist, n);
+			
+			// The piece wraps around the end of the buffer at most once
+			int head = Math.min(n, data.length - start);
+			out.write(data, start, head);
+			if (head < n)
+				out.write(data, 0, n - head);
+			len -= n;
+		}
+	}
+	
+	
+	/**
+	 * Copies {@code len} bytes starting at {@code dist} bytes ago to
+	 * the specified array and also back into this buffer itself.
+	 * @param dist the distance to go back, in the range [1, size]
+	 * @param len the length to copy, which must be at least 0
+	 * @param out the array to write to (not {@code null})
+	 * @param off the index in the array to write the first byte to
+	 * @throws NullPointerException if the array is {@code null}
+	 * @throws IllegalArgumentException if the length is negative,
+	 * distance is not positive, or distance is greater than the buffer size
+	 * @throws IndexOutOfBoundsException if the array range is out of bounds
+	 */
+	public void copy(int dist, int len, byte[] out, int off) {
+		Objects.requireNonNull(out);
+		if (len < 0 || dist < 1 || dist > data.length)
+			throw new IllegalArgumentException();
+		if (off < 0 || off > out.length - len)
+			throw new IndexOutOfBoundsException();
+		
+		// Same piecewise scheme as copying to an output stream
+		while (len > 0) {
+			int n = Math.min(len, data.length);
+			int start = index;
+			copyWithinBuffer(dist, n);
+			
+			int head = Math.min(n, data.length - start);
+			System.arraycopy(data, start, out, off, head);
+			if (head < n)
+				System.arraycopy(data, 0, out, off + head, n - head);
+			off += n;
+			len -= n;
+		}
+	}
+	
+	
+	/**
+	 * Copies {@code len} bytes starting at {@code dist} bytes ago back into this buffer
+	 * itself, without writing them anywhere else.
+	 * @param dist the distance to go back, in the range [1, size]
+	 * @param len the length to copy, which must be at least 0
+	 * @throws IllegalArgumentException if the length is negative,
+	 * distance is not positive, or distance is greater than the buffer size
+	 */
+	public void copy(int dist, int len) {
+		if (len < 0 || dist < 1 || dist > data.length)
+			throw new IllegalArgumentException();
+		while (len > 0) {
+			int n = Math.min(len, data.length);
+			copyWithinBuffer(dist, n);
+			len -= n;
+		}
+	}
+	
+	
+	/**
+	 * Updates the specified checksum with the most recent {@code len} bytes of this history, from oldest to newest.
+	 * @param sum the checksum to update (not {@code null})
+	 * @param len the number of bytes, in the range [0, size]
+	 * @throws NullPointerException if the checksum is {@code null}
+	 * @throws IllegalArgumentException if the length is negative or greater than the buffer size
+	 */
+	public void updateChecksum(Checksum sum, int len) {
+		Objects.requireNonNull(sum);
+		if (len < 0 || len > data.length)
+			throw new IllegalArgumentException();
+		int start = index - len;
+		if (start >= 0)
+			sum.update(data, start, len);
+		else {  // The bytes wrap around the end of the buffer
+			sum.update(data, data.length + start, -start);
+			sum.update(data, 0, index);
+		}
+	}
+	
+	
+	/**
+	 * Writes the most recent {@code len} bytes of this history to the specified output stream, from oldest to newest.
+	 * @param out the output stream to write to (not {@code null})
+	 * @param len the number of bytes, in the range [0, size]
+	 * @throws NullPointerException if the output stream is {@code null}
+	 * @throws IllegalArgumentException if the length is negative or greater than the buffer size
+	 * @throws IOException if an I/O exception occurs
+	 */
+	public void write(OutputStream out, int len) throws IOException {
+		Objects.requireNonNull(out);
+		if (len < 0 || len > data.length)
+			throw new IllegalArgumentException();
+		int start = index - len;
+		if (start >= 0)
+			out.write(data, start, len);
+		else {  // The bytes wrap around the end of the buffer
+			out.write(data, data.length + start, -start);
+			out.write(data, 0, index);
+		}
+	}
+	
+	
+	/**
+	 * Returns a new array of all the bytes in this history, from oldest to newest.
+	 * @return the contents of this history (not {@code null})
+	 */
+	public byte[] toByteArray() {
+		byte[] result = new byte[data.length];
+		System.arraycopy(data, index, result, 0, data.length - index);
+		System.arraycopy(data, 0, result, data.length - index, index);
+		return result;
+	}
+	
+	
+	// Copies len bytes starting at dist bytes ago to the current position and advances the
+	// index, where len is at most the buffer size and dist is in the range [1, buffer size].
+	private void copyWithinBuffer(int dist, int len) {
+		int readIndex = index - dist;
+		if (readIndex < 0)
+			readIndex += data.length;
 		if (readIndex < 0 || readIndex >= data.length)
 			throw new AssertionError();
 		
-		for (int i = 0; i < len; i++) {
-			byte b = data[readIndex];
-			readIndex = (readIndex + 1) % data.length;
-			out.write(b);
-			append(b);
+		if (readIndex + len <= data.length && index + len <= data.length) {
+			// Neither range wraps around. If they overlap, then the source necessarily starts
+			// before the destination, and the output is the dist bytes before the index
+			// repeated; so copy the pattern, doubling the amount available each time.
+			if (dist >= len)
+				System.arraycopy(data, readIndex, data, index, len);
+			else {
+				for (int copied = 0; copied < len; ) {
+					int n = Math.min(len - copied, dist + copied);
+					System.arraycopy(data, readIndex, data, index + copied, n);
+					copied += n;
+				}
+			}
+			index += len;
+			if (index == data.length) {
+				index = 0;
+				hasWrapped = true;
+			}
+		} else {
+			// Copy byte by byte, wrapping around at the end of the buffer
+			for (int i = 0; i < len; i++) {
+				data[index] = data[readIndex];
+				index++;
+				if (index == data.length) {
+					index = 0;
+					hasWrapped = true;
+				}
+				readIndex++;
+				if (readIndex == data.length)
+					readIndex = 0;
+			}
 		}
 	}
 	
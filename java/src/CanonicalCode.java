@@ -7,7 +7,6 @@
  */
 
 import java.io.IOException;
-import java.util.Arrays;
 import java.util.Objects;
 
 
@@ -42,22 +41,46 @@ import java.util.Objects;
 final class CanonicalCode {
 	
 	/* 
-	 * These arrays store the Huffman codes and values necessary for decoding.
-	 * symbolCodeBits contains Huffman codes, each padded with a 1 bit at the
-	 * beginning to disambiguate codes of different lengths (e.g. otherwise we
-	 * can't distinguish 0b01 from 0b0001). Each symbolCodeBits[i] decodes to its
-	 * corresponding symbolValues[i]. Values in symbolCodeBits are strictly increasing.
+	 * This array is a lookup table for decoding, indexed by upcoming bits of the stream in the
+	 * order they are read (i.e. the first bit read is the least significant bit of the index).
+	 * The first 1 << primaryBits entries form the primary table. A code of length n <= primaryBits
+	 * fills every primary entry whose low n bits match the code, so any window of primaryBits bits
+	 * that begins with the code looks up to its symbol. Codes longer than primaryBits that share
+	 * the same first primaryBits bits are placed in a subtable after the primary table; the
+	 * primary entry links to it, and it is indexed by the bits that follow in the same way.
 	 * 
-	 * For the example of codeLengths=[1,0,3,2,3], we would have:
-	 *   i | symbolCodeBits[i] | symbolValues[i]
-	 *   --+-------------------+----------------
-	 *   0 |             0b1_0 |               0
-	 *   1 |            0b1_10 |               3
-	 *   2 |           0b1_110 |               2
-	 *   3 |           0b1_111 |               4
+	 * Each entry packs (value << 4) | length. For a symbol entry, length is the
+	 * code length in [1, MAX_CODE_LENGTH] and value is the symbol. For a link entry,
+	 * length is 0 and value is (subtableOffset << 4) | subtableBits.
+	 * 
+	 * For the example of codeLengths=[1,0,3,2,3], we would have primaryBits=3 and:
+	 *   index | decodeTable[index]
+	 *   ------+-------------------
+	 *   0b000 | symbol 0, length 1
+	 *   0b001 | symbol 3, length 2
+	 *   0b010 | symbol 0, length 1
+	 *   0b011 | symbol 2, length 3
+	 *   0b100 | symbol 0, length 1
+	 *   0b101 | symbol 3, length 2
+	 *   0b110 | symbol 0, length 1
+	 *   0b111 | symbol 4, length 3
 	 */
-	private int[] symbolCodeBits;
-	private int[] symbolValues;
+	private int[] decodeTable;
+	
+	// Number of index bits in the primary table, in the range [1, MAX_CODE_LENGTH].
+	private int primaryBits;
+	
+	/* 
+	 * For a code with more than 256 symbols (i.e. a literal/length code), this table is indexed like the
+	 * primary table, and each entry describes the two literal symbols whose codes come first in the window,
+	 * if both are literals (symbol < 256) and both codes fit in primaryBits bits together. Such an entry
+	 * packs (secondLiteral << 16) | (firstLiteral << 8) | totalCodeLength, and any other entry is zero.
+	 * For smaller alphabets this is null.
+	 */
+	private int[] literalPairTable;
+	
+	// A copy of the code lengths this code was constructed from, used for toString().
+	private int[] codeLengths;
 	
 	
 	
@@ -89,18 +112,18 @@ final class CanonicalCode {
 	public CanonicalCode(int[] codeLengths) {
 		// Check argument values
 		Objects.requireNonNull(codeLengths);
+		int maxCodeLength = 0;
 		for (int x : codeLengths) {
 			if (x < 0)
 				throw new IllegalArgumentException("Negative code length");
 			if (x > MAX_CODE_LENGTH)
 				throw new IllegalArgumentException("Maximum code length exceeded");
+			maxCodeLength = Math.max(x, maxCodeLength);
 		}
 		
 		// Allocate code values to symbols. Symbols are processed in the order
 		// of shortest code length first, breaking ties by lowest symbol value.
-		symbolCodeBits = new int[codeLengths.length];
-		symbolValues   = new int[codeLengths.length];
-		int numSymbolsAllocated = 0;
+		int[] symbolCodes = new int[codeLengths.length];
 		int nextCode = 0;
 		for (int codeLength = 1; codeLength <= MAX_CODE_LENGTH; codeLength++) {
 			nextCode <<= 1;
@@ -111,18 +134,74 @@ final class CanonicalCode {
 				if (nextCode >= startBit)
 					throw new IllegalArgumentException("This canonical code produces an over-full Huffman code tree");
 				
-				symbolCodeBits[numSymbolsAllocated] = startBit | nextCode;
-				symbolValues  [numSymbolsAllocated] = symbol;
-				numSymbolsAllocated++;
+				symbolCodes[symbol] = nextCode;
 				nextCode++;
 			}
 		}
 		if (nextCode != 1 << MAX_CODE_LENGTH)
 			throw new IllegalArgumentException("This canonical code produces an under-full Huffman code tree");
+		this.codeLengths = codeLengths.clone();
+		
+		// Determine the size of the subtable (if any) under each primary table entry
+		primaryBits = Math.min(maxCodeLength, codeLengths.length > 32 ? LITERAL_LENGTH_PRIMARY_BITS : OTHER_PRIMARY_BITS);
+		int[] subtableBits = new int[1 << primaryBits];
+		for (int symbol = 0; symbol < codeLengths.length; symbol++) {
+			int len = codeLengths[symbol];
+			if (len > primaryBits) {
+				int prefix = reverseBits(symbolCodes[symbol] >>> (len - primaryBits), primaryBits);
+				subtableBits[prefix] = Math.max(len - primaryBits, subtableBits[prefix]);
+			}
+		}
 		
-		// Trim unused trailing elements
-		symbolCodeBits = Arrays.copyOf(symbolCodeBits, numSymbolsAllocated);
-		symbolValues   = Arrays.copyOf(symbolValues  , numSymbolsAllocated);
+		// Lay out the subtables after the primary table and create the link entries
+		int[] subtableOffsets = new int[1 << primaryBits];
+		int tableSize = 1 << primaryBits;
+		for (int i = 0; i < subtableBits.length; i++) {
+			if (subtableBits[i] > 0) {
+				subtableOffsets[i] = tableSize;
+				tableSize += 1 << subtableBits[i];
+			}
+		}
+		decodeTable = new int[tableSize];
+		for (int i = 0; i < subtableBits.length; i++) {
+			if (subtableBits[i] > 0)
+				decodeTable[i] = (subtableOffsets[i] << 4 | subtableBits[i]) << 4;
+		}
+		
+		// Fill in the symbol entries. Because the code tree is full, every entry gets filled.
+		for (int symbol = 0; symbol < codeLengths.length; symbol++) {
+			int len = codeLengths[symbol];
+			if (len == 0)
+				continue;
+			int reversed = reverseBits(symbolCodes[symbol], len);
+			int entry = symbol << 4 | len;
+			if (len <= primaryBits) {
+				for (int i = reversed; i < 1 << primaryBits; i += 1 << len)
+					decodeTable[i] = entry;
+			} else {
+				int prefix = reversed & ((1 << primaryBits) - 1);
+				int offset = subtableOffsets[prefix];
+				for (int i = reversed >>> primaryBits; i < 1 << subtableBits[prefix]; i += 1 << (len - primaryBits))
+					decodeTable[offset + i] = entry;
+			}
+		}
+		
+		// Pair up literals whose codes are short enough. The bits after the first code are looked up in the
+		// primary table with the missing high bits as zeros, which is exact when the second code fits in them.
+		if (codeLengths.length > 256) {
+			literalPairTable = new int[1 << primaryBits];
+			for (int i = 0; i < literalPairTable.length; i++) {
+				int first = decodeTable[i];
+				int len1 = first & 0xF;
+				if (len1 == 0 || first >>> 4 >= 256 || len1 >= primaryBits)
+					continue;
+				int second = decodeTable[i >>> len1];
+				int len2 = second & 0xF;
+				if (len2 == 0 || second >>> 4 >= 256 || len1 + len2 > primaryBits)
+					continue;
+				literalPairTable[i] = (second >>> 4) << 16 | (first >>> 4) << 8 | (len1 + len2);
+			}
+		}
 	}
 	
 	
@@ -136,16 +215,79 @@ final class CanonicalCode {
 	 */
 	public int decodeNextSymbol(BitInputStream in) throws IOException {
 		Objects.requireNonNull(in);
-		int codeBits = 1;  // The start bit
+		if (in instanceof PeekableBitInputStream) {
+			// Look up the code at the start of the upcoming bits in one step. Near the end of
+			// the stream the peeked bits are padded with zeros, but a code that extends past
+			// the end still fails when its bits are consumed.
+			PeekableBitInputStream pin = (PeekableBitInputStream)in;
+			int entry = lookup(pin.peekBits(MAX_CODE_LENGTH));
+			pin.consumeBits(entry & 0xF);
+			return entry >>> 4;
+		}
+		
+		int bits = 0;
+		int numBits = 0;
 		while (true) {
-			// Accumulate one bit at a time on the right side until a match is
-			// found in the symbolCodeBits array. Because the Huffman code tree is
-			// full, this loop must terminate after at most MAX_CODE_LENGTH iterations.
-			codeBits = codeBits << 1 | in.readNoEof();
-			int index = Arrays.binarySearch(symbolCodeBits, codeBits);
-			if (index >= 0)
-				return symbolValues[index];
+			// Accumulate one bit at a time on the left side, and look up the bits read so far
+			// with the unread bits taken as zero. Because codes are prefix-free, the entry found
+			// is the answer as soon as its code length is covered by the bits read. Because the
+			// Huffman code tree is full, this loop terminates after at most MAX_CODE_LENGTH iterations.
+			bits |= in.readNoEof() << numBits;
+			numBits++;
+			int entry = lookup(bits);
+			if ((entry & 0xF) <= numBits)
+				return entry >>> 4;
+		}
+	}
+	
+	
+	// Returns (symbol << 4) | codeLength for the code at the start of the given window of upcoming bits,
+	// where the window is at least as long as the code (any bits beyond the code are ignored).
+	int lookup(int bits) {
+		int entry = decodeTable[bits & ((1 << primaryBits) - 1)];
+		if ((entry & 0xF) == 0) {  // Link to a subtable
+			int subtableBits = (entry >>> 4) & 0xF;
+			entry = decodeTable[(entry >>> 8) + ((bits >>> primaryBits) & ((1 << subtableBits) - 1))];
 		}
+		return entry;
+	}
+	
+	
+	// Returns the number of symbols in this code's alphabet, which is codeLengths.length.
+	int getSymbolLimit() {
+		return codeLengths.length;
+	}
+	
+	
+	// Returns the number of index bits in the primary table.
+	int getPrimaryBits() {
+		return primaryBits;
+	}
+	
+	
+	// Returns the total length of the primary table and the subtables.
+	int getTableSize() {
+		return decodeTable.length;
+	}
+	
+	
+	// Returns the raw entry at the given index of the decode table, including link entries.
+	int getTableEntry(int index) {
+		return decodeTable[index];
+	}
+	
+	
+	// For a literal/length code, returns (secondLiteral << 16) | (firstLiteral << 8) | totalCodeLength if the
+	// given window of upcoming bits starts with the codes of two literals that together fit in the primary
+	// table's bits, otherwise 0. The window must hold at least the primary table's bits.
+	int lookupLiteralPair(int bits) {
+		return literalPairTable[bits & ((1 << primaryBits) - 1)];
+	}
+	
+	
+	// Returns the lowest numBits bits of the given value in reverse order.
+	private static int reverseBits(int value, int numBits) {
+		return Integer.reverse(value) >>> (32 - numBits);
 	}
 	
 	
@@ -155,11 +297,19 @@ final class CanonicalCode {
 	 * @return a string representation of this canonical code
 	 */
 	public String toString() {
+		// Regenerate the codes in the same order they were allocated
 		StringBuilder sb = new StringBuilder();
-		for (int i = 0; i < symbolCodeBits.length; i++) {
-			sb.append(String.format("Code %s: Symbol %d%n",
-				Integer.toBinaryString(symbolCodeBits[i]).substring(1),
-				symbolValues[i]));
+		int nextCode = 0;
+		for (int codeLength = 1; codeLength <= MAX_CODE_LENGTH; codeLength++) {
+			nextCode <<= 1;
+			for (int symbol = 0; symbol < codeLengths.length; symbol++) {
+				if (codeLengths[symbol] != codeLength)
+					continue;
+				sb.append(String.format("Code %s: Symbol %d%n",
+					Integer.toBinaryString(1 << codeLength | nextCode).substring(1),
+					symbol));
+				nextCode++;
+			}
 		}
 		return sb.toString();
 	}
@@ -169,4 +319,9 @@ final class CanonicalCode {
 	// The maximum Huffman code length allowed in the DEFLATE standard.
 	private static final int MAX_CODE_LENGTH = 15;
 	
+	// Maximum primary table sizes, for large alphabets (literal/length codes)
+	// and for small alphabets (distance codes and the code length code).
+	private static final int LITERAL_LENGTH_PRIMARY_BITS = 10;
+	private static final int OTHER_PRIMARY_BITS = 8;
+	
 }
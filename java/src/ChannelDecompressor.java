@@ -0,0 +1,264 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.ReadOnlyBufferException;
+import java.nio.channels.AsynchronousFileChannel;
+import java.nio.channels.CompletionHandler;
+import java.nio.channels.ReadableByteChannel;
+import java.util.Objects;
+import java.util.zip.DataFormatException;
+
+
+/**
+ * Decompresses raw DEFLATE data with NIO byte buffers and channels, for event loops that must never block.
+ * Compressed bytes come in as byte buffers, or straight from a (non-blocking) readable channel or from the
+ * completion of an asynchronous file read. Output goes into buffers supplied by the caller, or is returned as
+ * slices of an internal buffer. Nothing is decoded until output is asked for, so when the downstream buffers are
+ * full the caller simply stops asking; the next call resumes exactly where decoding stopped, even in the middle
+ * of a block or a copy. Likewise {@link #needsInput()} tells when to read more, so the input held is bounded.
+ * This wraps a {@link ResumableDecompressor} that takes fed input. Mutable and not thread-safe; while an
+ * asynchronous read is pending, no other method may be called until its handler runs.
+ */
+public final class ChannelDecompressor {
+	
+	/*---- Fields ----*/
+	
+	private final ResumableDecompressor decomp;
+	
+	// Staging array for input that is not in an accessible array, and the buffer that channels read into.
+	private final byte[] inputArray;
+	private final ByteBuffer inputBuffer;
+	
+	// Staging array for output to buffers without an accessible array, and for returned slices.
+	private final byte[] outputArray;
+	
+	// Whether an asynchronous read has been started and its completion has not been handled yet.
+	private volatile boolean readPending;
+	
+	
+	
+	/*---- Constructor ----*/
+	
+	/**
+	 * Constructs a decompressor with no input yet.
+	 */
+	public ChannelDecompressor() {
+		decomp = new ResumableDecompressor();
+		inputArray = new byte[BUFFER_SIZE];
+		inputBuffer = ByteBuffer.wrap(inputArray);
+		outputArray = new byte[BUFFER_SIZE];
+		readPending = false;
+	}
+	
+	
+	
+	/*---- Input methods ----*/
+	
+	/**
+	 * Appends all the remaining bytes of the specified buffer to the input, advancing its position to its limit.
+	 * The bytes are copied, so the buffer can be reused (e.g. released to a pool) after this returns.
+	 * @param src the buffer of compressed bytes (not {@code null})
+	 * @throws NullPointerException if the buffer is {@code null}
+	 * @throws IllegalStateException if an asynchronous read is pending
+	 */
+	public void feed(ByteBuffer src) {
+		Objects.requireNonNull(src);
+		checkNoReadPending();
+		if (src.hasArray()) {
+			decomp.feed(src.array(), src.arrayOffset() + src.position(), src.remaining());
+			src.position(src.limit());
+		} else {
+			while (src.hasRemaining()) {
+				int n = Math.min(src.remaining(), inputArray.length);
+				src.get(inputArray, 0, n);
+				decomp.feed(inputArray, 0, n);
+			}
+		}
+	}
+	
+	
+	/**
+	 * Reads once from the specified channel and appends the bytes read to the input. With a
+	 * non-blocking channel this does not block, and returns 0 if no bytes are available yet.
+	 * To bound the memory used, call this only when {@link #needsInput()} is true.
+	 * @param ch the channel to read from (not {@code null})
+	 * @return the number of bytes read, or &minus;1 if the channel has reached its end
+	 * @throws NullPointerException if the channel is {@code null}
+	 * @throws IllegalStateException if an asynchronous read is pending
+	 * @throws IOException if the channel throws an I/O exception
+	 */
+	public int readFrom(ReadableByteChannel ch) throws IOException {
+		Objects.requireNonNull(ch);
+		checkNoReadPending();
+		inputBuffer.clear();
+		int result = ch.read(inputBuffer);
+		if (result > 0)
+			decomp.feed(inputArray, 0, result);
+		return result;
+	}
+	
+	
+	/**
+	 * Starts reading from the specified file channel at the specified position, and returns immediately.
+	 * When the read completes, the bytes read are appended to the input and then the handler is called with
+	 * the number of bytes read (&minus;1 at the end of the file), on whichever thread the channel uses.
+	 * No other method of this object may be called until the handler runs.
+	 * @param <A> the type of the attachment
+	 * @param ch the channel to read from (not {@code null})
+	 * @param position the file position to read at, which must be non-negative
+	 * @param attachment the object to pass to the handler (can be {@code null})
+	 * @param handler the handler for the result of the read (not {@code null})
+	 * @throws NullPointerException if the channel or handler is {@code null}
+	 * @throws IllegalArgumentException if the position is negative
+	 * @throws IllegalStateException if an asynchronous read is already pending
+	 */
+	public <A> void readFrom(AsynchronousFileChannel ch, long position, A attachment, final CompletionHandler<Integer,? super A> handler) {
+		Objects.requireNonNull(ch);
+		Objects.requireNonNull(handler);
+		if (position < 0)
+			throw new IllegalArgumentException("Negative position");
+		checkNoReadPending();
+		inputBuffer.clear();
+		readPending = true;
+		try {
+			ch.read(inputBuffer, position, attachment, new CompletionHandler<Integer,A>() {
+				public void completed(Integer result, A att) {
+					if (result > 0)
+						decomp.feed(inputArray, 0, result);
+					readPending = false;
+					handler.completed(result, att);
+				}
+				
+				public void failed(Throwable exc, A att) {
+					readPending = false;
+					handler.failed(exc, att);
+				}
+			});
+		} catch (RuntimeException e) {
+			readPending = false;
+			throw e;
+		}
+	}
+	
+	
+	/**
+	 * Tests whether decoding cannot make progress until more input is given, because the fed input ran out
+	 * in the last call to a decompress method and nothing has been fed since. Initially true.
+	 * @return whether more input is needed
+	 */
+	public boolean needsInput() {
+		return decomp.needsInput();
+	}
+	
+	
+	
+	/*---- Output methods ----*/
+	
+	/**
+	 * Decompresses data into the remaining space of the specified buffer, advancing its position by the number
+	 * of bytes written. Stops when the buffer is full, when the input runs out (then {@link #needsInput()}
+	 * becomes true), or at the end of the stream. Returns &minus;1 if the stream has ended and no bytes were
+	 * written (but 0 if the buffer has no space). After an exception, this object must be reset before reuse.
+	 * @param dst the buffer to write to (not {@code null})
+	 * @return the number of bytes written, or &minus;1 at the end of the stream
+	 * @throws NullPointerException if the buffer is {@code null}
+	 * @throws ReadOnlyBufferException if the buffer is read-only
+	 * @throws IllegalStateException if an asynchronous read is pending
+	 * @throws DataFormatException if the DEFLATE data is malformed
+	 */
+	public int decompress(ByteBuffer dst) throws IOException, DataFormatException {
+		Objects.requireNonNull(dst);
+		if (dst.isReadOnly())
+			throw new ReadOnlyBufferException();
+		checkNoReadPending();
+		if (dst.hasArray()) {
+			// Decode straight into the buffer's array
+			int n = decomp.decompress(dst.array(), dst.arrayOffset() + dst.position(), dst.remaining());
+			if (n > 0)
+				dst.position(dst.position() + n);
+			return n;
+		}
+		
+		int total = 0;
+		while (dst.hasRemaining()) {
+			int len = Math.min(dst.remaining(), outputArray.length);
+			int n = decomp.decompress(outputArray, 0, len);
+			if (n == -1)
+				return total > 0 ? total : -1;
+			dst.put(outputArray, 0, n);
+			total += n;
+			if (n < len)
+				break;  // Input ran out, or the stream ended
+		}
+		return total;
+	}
+	
+	
+	/**
+	 * Decompresses the next piece of data into an internal array and returns a read-only buffer
+	 * over it, which stays valid until the next call of any method on this object. The buffer
+	 * is empty if the input ran out before any byte was decoded (then {@link #needsInput()} is true).
+	 * @return a buffer of at most 64 KiB of output, or {@code null} at the end of the stream
+	 * @throws IllegalStateException if an asynchronous read is pending
+	 * @throws DataFormatException if the DEFLATE data is malformed
+	 */
+	public ByteBuffer decompressSlice() throws IOException, DataFormatException {
+		checkNoReadPending();
+		int n = decomp.decompress(outputArray, 0, outputArray.length);
+		if (n == -1)
+			return null;
+		return ByteBuffer.wrap(outputArray, 0, n).slice().asReadOnlyBuffer();
+	}
+	
+	
+	
+	/*---- Other methods ----*/
+	
+	/**
+	 * Tests whether the end of the DEFLATE stream has been decoded.
+	 * @return whether decompression has finished
+	 * @see ResumableDecompressor#isFinished()
+	 */
+	public boolean isFinished() {
+		return decomp.isFinished();
+	}
+	
+	
+	/**
+	 * Returns the number of input bytes that have not been used. After the stream has finished,
+	 * these are the bytes that follow the DEFLATE data (such as a container's trailer).
+	 * @return the number of unused input bytes
+	 */
+	public int getRemaining() {
+		return decomp.getRemaining();
+	}
+	
+	
+	/**
+	 * Resets this decompressor to decode a new stream, discarding any input and state of the
+	 * current stream (even after an exception). The internal buffers and tables are kept.
+	 * @throws IllegalStateException if an asynchronous read is pending
+	 */
+	public void reset() {
+		checkNoReadPending();
+		decomp.reset();
+	}
+	
+	
+	private void checkNoReadPending() {
+		if (readPending)
+			throw new IllegalStateException("Asynchronous read pending");
+	}
+	
+	
+	// The size of the staging arrays, which is also the most read from a channel at once and the largest returned slice.
+	private static final int BUFFER_SIZE = 64 * 1024;
+	
+}
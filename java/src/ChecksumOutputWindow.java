@@ -0,0 +1,171 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.io.IOException;
+import java.io.OutputStream;
+import java.util.Objects;
+import java.util.zip.CRC32;
+
+
+/**
+ * An output window that keeps only the last 32 KiB in a byte history and a running CRC-32 and length
+ * of the data, for verifying a stream without storing its output. The CRC is computed straight from
+ * the history in batches, before the bytes could be overwritten. Optionally, each batch is also written
+ * to an output stream right after its CRC, while it is still in cache. Mutable and not thread-safe.
+ */
+final class ChecksumOutputWindow implements OutputWindow {
+	
+	/*---- Fields ----*/
+	
+	private ByteHistory dictionary;
+	
+	private OutputStream output;  // Can be null
+	
+	private CRC32 crc;
+	
+	private long length;
+	
+	// Number of the most recent bytes in the history that have not gone through the CRC (and to the output) yet, less than FLUSH_SIZE
+	// between method calls. Any piece appended at once is at most HISTORY_SIZE - pending, so it never overwrites them.
+	private int pending;
+	
+	
+	
+	/*---- Constructors ----*/
+	
+	/**
+	 * Constructs an output window for a new stream, where the CRC and length start at zero.
+	 */
+	public ChecksumOutputWindow() {
+		dictionary = new ByteHistory(HISTORY_SIZE);
+		output = null;
+		crc = new CRC32();
+		length = 0;
+		pending = 0;
+	}
+	
+	
+	/**
+	 * Constructs an output window for a new stream, where the CRC and length start at zero, that also writes
+	 * all the data to the specified output stream. The last bytes are written only by {@link #getCrc()}.
+	 * @param out the output stream to write to (not {@code null})
+	 * @throws NullPointerException if the output stream is {@code null}
+	 */
+	public ChecksumOutputWindow(OutputStream out) {
+		dictionary = new ByteHistory(HISTORY_SIZE);
+		output = Objects.requireNonNull(out);
+		crc = new CRC32();
+		length = 0;
+		pending = 0;
+	}
+	
+	
+	
+	/*---- Methods ----*/
+	
+	public void append(int b) throws IOException {
+		dictionary.append(b);
+		length++;
+		pending++;
+		if (pending >= FLUSH_SIZE)
+			flush();
+	}
+	
+	
+	public void append(byte[] b, int off, int len) throws IOException {
+		flush();  // Keep the CRC and output in order
+		crc.update(b, off, len);
+		if (output != null)
+			output.write(b, off, len);
+		dictionary.append(b, off, len);
+		length += len;
+	}
+	
+	
+	public int appendFrom(PeekableBitInputStream in, int len) throws IOException {
+		if (len < 0)
+			throw new IllegalArgumentException();
+		int count = 0;
+		while (count < len) {
+			int n = Math.min(len - count, HISTORY_SIZE - pending);
+			int k = dictionary.appendFrom(in, n);
+			count += k;
+			pending += k;
+			if (pending >= FLUSH_SIZE)
+				flush();
+			if (k < n)
+				break;
+		}
+		length += count;
+		return count;
+	}
+	
+	
+	public void copy(int dist, int len) throws IOException {
+		if (len < 0)
+			throw new IllegalArgumentException();
+		length += len;
+		while (len > 0) {
+			int n = Math.min(len, HISTORY_SIZE - pending);
+			dictionary.copy(dist, n);
+			len -= n;
+			pending += n;
+			if (pending >= FLUSH_SIZE)
+				flush();
+		}
+	}
+	
+	
+	/**
+	 * Returns the CRC-32 of all the data output since construction or the last reset,
+	 * after writing any data not yet written to the output stream (if there is one).
+	 * @return the CRC-32 of the output (not {@code null}), which stays owned by this object
+	 * @throws IOException if an I/O exception occurs
+	 */
+	public CRC32 getCrc() throws IOException {
+		flush();
+		return crc;
+	}
+	
+	
+	/**
+	 * Returns the number of bytes output since construction or the last reset.
+	 * @return the length of the output
+	 */
+	public long getLength() {
+		return length;
+	}
+	
+	
+	/**
+	 * Resets this window for a new stream: the history becomes all zeros, and the CRC and length restart at zero.
+	 * Any data not yet written to the output stream is discarded, so call {@link #getCrc()} first if there is one.
+	 */
+	public void reset() {
+		dictionary.reset();
+		crc.reset();
+		length = 0;
+		pending = 0;
+	}
+	
+	
+	// Updates the CRC with the pending bytes, and writes them to the output stream if there is one.
+	private void flush() throws IOException {
+		dictionary.updateChecksum(crc, pending);
+		if (output != null)
+			dictionary.write(output, pending);
+		pending = 0;
+	}
+	
+	
+	private static final int HISTORY_SIZE = 32 * 1024;
+	
+	// Batching the CRC over this many bytes amortizes the cost of each update call.
+	private static final int FLUSH_SIZE = HISTORY_SIZE / 2;
+	
+}
@@ -0,0 +1,30 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.io.IOException;
+
+
+/**
+ * Thrown when decompression stops because the output would exceed a {@link DecompressionLimits} limit.
+ * The DEFLATE data itself may be well-formed; it just expands to more than the caller allows.
+ * Only the methods that take a {@code DecompressionLimits} argument throw this.
+ */
+public final class DecompressionLimitException extends IOException {
+	
+	/**
+	 * Constructs an exception with the specified detail message.
+	 * @param message the detail message, which tells which limit was exceeded
+	 */
+	public DecompressionLimitException(String message) {
+		super(message);
+	}
+	
+	
+	private static final long serialVersionUID = 1L;
+	
+}
@@ -0,0 +1,60 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+
+/**
+ * Limits on how much output untrusted DEFLATE data may produce, for rejecting decompression bombs
+ * before they use up memory or disk. The limits are enforced before each literal, match, or stored
+ * block is materialized, so decoding stops with a {@link DecompressionLimitException} as soon as
+ * the next piece of output would break a limit. Immutable and thread-safe.
+ * <p>Only the methods that take a {@code DecompressionLimits} argument enforce the limits, namely the
+ * {@code Decompressor.decompress} overloads and the four-argument {@code ZlibDecompressor.decompress}.
+ * The other decoders do not: {@link ResumableDecompressor}, {@link DecompressorPool}, and
+ * {@link ChannelDecompressor} hand out output in pieces the caller asks for, so the caller can count it
+ * and stop; and {@link ParallelDecompressor}, {@link BatchDecompressor}, and the gzip command-line
+ * program are meant for trusted input and decode it without any limit.</p>
+ * @see Decompressor#decompress(BitInputStream, DecompressionLimits)
+ * @see Decompressor#decompress(BitInputStream, java.io.OutputStream, DecompressionLimits)
+ * @see ZlibDecompressor#decompress(BitInputStream, java.io.OutputStream, byte[], DecompressionLimits)
+ */
+public final class DecompressionLimits {
+	
+	/*---- Fields ----*/
+	
+	/** The maximum number of output bytes, at least 0, where {@code Long.MAX_VALUE} means no limit. */
+	public final long maxOutputBytes;
+	
+	/** The maximum ratio of output bytes to the input bytes consumed so far, at least 1, where infinity means
+	 * no limit. The ratio is only checked once the output exceeds {@link #RATIO_GRACE_BYTES}, because
+	 * the beginning of a legitimate stream can expand a lot before much input has been consumed. */
+	public final double maxRatio;
+	
+	
+	/** The amount of output that is always allowed regardless of the ratio limit, namely 1 MiB. */
+	public static final long RATIO_GRACE_BYTES = 1 << 20;
+	
+	
+	
+	/*---- Constructor ----*/
+	
+	/**
+	 * Constructs a set of limits with the specified values.
+	 * @param maxOutputBytes the maximum number of output bytes, or {@code Long.MAX_VALUE} for no limit
+	 * @param maxRatio the maximum expansion ratio, or {@code Double.POSITIVE_INFINITY} for no limit
+	 * @throws IllegalArgumentException if the byte limit is negative or the ratio is less than 1 or NaN
+	 */
+	public DecompressionLimits(long maxOutputBytes, double maxRatio) {
+		if (maxOutputBytes < 0)
+			throw new IllegalArgumentException("Negative output limit");
+		if (!(maxRatio >= 1))
+			throw new IllegalArgumentException("Ratio limit must be at least 1");
+		this.maxOutputBytes = maxOutputBytes;
+		this.maxRatio = maxRatio;
+	}
+	
+}
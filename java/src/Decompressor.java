@@ -6,10 +6,10 @@
  * https://github.com/nayuki/Simple-DEFLATE-decompressor
  */
 
-import java.io.ByteArrayOutputStream;
 import java.io.EOFException;
 import java.io.IOException;
 import java.io.OutputStream;
+import java.nio.ByteBuffer;
 import java.util.Arrays;
 import java.util.Objects;
 import java.util.zip.DataFormatException;
@@ -29,8 +29,9 @@ public final class Decompressor {
 	 * @throws DataFormatException if the DEFLATE data is malformed
 	 */
 	public static byte[] decompress(BitInputStream in) throws IOException, DataFormatException {
-		ByteArrayOutputStream out = new ByteArrayOutputStream();
-		decompress(in, out);
+		// The output array doubles as the history, so no separate dictionary is needed
+		ByteArrayOutputWindow out = new ByteArrayOutputWindow();
+		new Decompressor(in, out, null);
 		return out.toByteArray();
 	}
 	
@@ -43,7 +44,91 @@ public final class Decompressor {
 	 * @throws DataFormatException if the DEFLATE data is malformed
 	 */
 	public static void decompress(BitInputStream in, OutputStream out) throws IOException, DataFormatException {
-		new Decompressor(in, out);
+		new Decompressor(in, new StreamOutputWindow(out), null);
+	}
+	
+	
+	/**
+	 * Reads from the specified input stream, decompress the data, and writes to the specified output stream,
+	 * reporting statistics about each block to the specified listener. This decodes every block with the general
+	 * Huffman decoding loop (not the fixed-code fast path) and counts the input bits through a wrapper, so it is
+	 * somewhat slower; the methods without a listener run the uninstrumented code and pay nothing for this feature.
+	 * @param in the bit input stream to read from (not {@code null})
+	 * @param out the byte output stream to write to (not {@code null})
+	 * @param listener the listener to report each decoded block to (not {@code null})
+	 * @throws NullPointerException if the input stream, output stream, or listener is {@code null}
+	 * @throws DataFormatException if the DEFLATE data is malformed
+	 */
+	public static void decompress(BitInputStream in, OutputStream out, DecompressorListener listener) throws IOException, DataFormatException {
+		new Decompressor(in, new StreamOutputWindow(out), Objects.requireNonNull(listener));
+	}
+	
+	
+	/**
+	 * Reads from the specified input stream, decompresses the data, and returns a new byte array, stopping as soon
+	 * as the output would exceed the specified limits. No more output than the byte limit is ever produced.
+	 * The other decoders in this package do not take limits; see {@link DecompressionLimits} for which are covered.
+	 * @param in the bit input stream to read from (not {@code null})
+	 * @param limits the limits on the output (not {@code null})
+	 * @throws NullPointerException if the input stream or limits is {@code null}
+	 * @throws DecompressionLimitException if the output would exceed a limit
+	 * @throws DataFormatException if the DEFLATE data is malformed
+	 */
+	public static byte[] decompress(BitInputStream in, DecompressionLimits limits) throws IOException, DataFormatException {
+		ByteArrayOutputWindow out = new ByteArrayOutputWindow();
+		decompressLimited(in, out, limits);
+		return out.toByteArray();
+	}
+	
+	
+	/**
+	 * Reads from the specified input stream, decompresses the data, and writes to the specified output stream,
+	 * stopping as soon as the output would exceed the specified limits. Output written before a limit is reached
+	 * stays written, so the caller should discard it when a {@link DecompressionLimitException} is thrown.
+	 * The other decoders in this package do not take limits; see {@link DecompressionLimits} for which are covered.
+	 * @param in the bit input stream to read from (not {@code null})
+	 * @param out the byte output stream to write to (not {@code null})
+	 * @param limits the limits on the output (not {@code null})
+	 * @throws NullPointerException if the input stream, output stream, or limits is {@code null}
+	 * @throws DecompressionLimitException if the output would exceed a limit
+	 * @throws DataFormatException if the DEFLATE data is malformed
+	 */
+	public static void decompress(BitInputStream in, OutputStream out, DecompressionLimits limits) throws IOException, DataFormatException {
+		decompressLimited(in, new StreamOutputWindow(out), limits);
+	}
+	
+	
+	/**
+	 * Reads from the specified buffer in place, decompresses the data, and returns a new byte array. The data
+	 * starts at the buffer's position, and on success the position is advanced to just after the end of the
+	 * DEFLATE data. The buffer can be memory-mapped; its contents are not copied into intermediate arrays.
+	 * @param in the byte buffer to read from (not {@code null})
+	 * @throws NullPointerException if the buffer is {@code null}
+	 * @throws EOFException if the buffer ends before the DEFLATE data does
+	 * @throws DataFormatException if the DEFLATE data is malformed
+	 */
+	public static byte[] decompress(ByteBuffer in) throws IOException, DataFormatException {
+		ByteBufferBitInputStream bitIn = new ByteBufferBitInputStream(in);
+		byte[] result = decompress(bitIn);
+		in.position(bitIn.getPosition());
+		return result;
+	}
+	
+	
+	/**
+	 * Reads from the specified buffer in place, decompresses the data, and writes to the specified output stream.
+	 * The data starts at the buffer's position, and on success the position is advanced to just after the end
+	 * of the DEFLATE data. The buffer can be memory-mapped; its contents are not copied into intermediate arrays.
+	 * @param in the byte buffer to read from (not {@code null})
+	 * @param out the byte output stream to write to (not {@code null})
+	 * @throws NullPointerException if the buffer or output stream is {@code null}
+	 * @throws EOFException if the buffer ends before the DEFLATE data does
+	 * @throws DataFormatException if the DEFLATE data is malformed
+	 */
+	public static void decompress(ByteBuffer in, OutputStream out) throws IOException, DataFormatException {
+		ByteBufferBitInputStream bitIn = new ByteBufferBitInputStream(in);
+		decompress(bitIn, out);
+		in.position(bitIn.getPosition());
 	}
 	
 	
@@ -52,46 +137,137 @@ public final class Decompressor {
 	
 	private BitInputStream input;
 	
-	private OutputStream output;
+	private OutputWindow output;
 	
-	private ByteHistory dictionary;
+	private HuffmanTableCache cache;
 	
 	
 	
-	// Constructor, which immediately performs decompression
-	private Decompressor(BitInputStream in, OutputStream out) throws IOException, DataFormatException {
+	// Constructor, which immediately performs decompression.
+	// The listener is null for the normal uninstrumented path.
+	private Decompressor(BitInputStream in, OutputWindow out, DecompressorListener listener) throws IOException, DataFormatException {
 		// Initialize fields
 		input = Objects.requireNonNull(in);
 		output = Objects.requireNonNull(out);
-		dictionary = new ByteHistory(32 * 1024);
-		
-		// Process the stream of blocks
+		cache = THREAD_CACHE.get();
+		if (listener != null)
+			decompressWithStatistics(listener);
+		else
+			decompressBlocks();
+	}
+	
+	
+	// Constructor for decoding a sequence of streams into the given window with one
+	// decompressor, where each stream is decoded by decompressStream().
+	Decompressor(OutputWindow out) {
+		output = Objects.requireNonNull(out);
+		cache = THREAD_CACHE.get();
+	}
+	
+	
+	// Decodes the whole DEFLATE stream from the given input, appending to the output window.
+	void decompressStream(BitInputStream in) throws IOException, DataFormatException {
+		input = Objects.requireNonNull(in);
+		decompressBlocks();
+	}
+	
+	
+	// Processes the stream of blocks from the input.
+	private void decompressBlocks() throws IOException, DataFormatException {
+		BitInputStream in = input;
 		boolean isFinal;
 		do {
 			// Read the block header
 			isFinal = in.readNoEof() == 1;  // bfinal
-			int type = readInt(2);  // btype
+			int type = readInt(2, in);  // btype
 			
 			// Decompress rest of block based on the type
 			if (type == 0)
 				decompressUncompressedBlock();
+			else if (type == 1) {
+				if (in instanceof PeekableBitInputStream)
+					decompressFixedHuffmanBlock((PeekableBitInputStream)in);
+				else
+					decompressHuffmanBlock(FIXED_LITERAL_LENGTH_CODE, FIXED_DISTANCE_CODE);
+			} else if (type == 2) {
+				CanonicalCode[] litLenAndDist = decodeHuffmanCodes(in, cache);
+				decompressHuffmanBlock(litLenAndDist[0], litLenAndDist[1]);
+			} else if (type == 3)
+				throw new DataFormatException("Reserved block type");
+			else
+				throw new AssertionError("Impossible value");
+		} while (!isFinal);
+	}
+	
+	
+	// Decompresses the stream of blocks like the constructor, but through a bit-counting wrapper
+	// and the instrumented Huffman loop, reporting each block's statistics to the listener.
+	private void decompressWithStatistics(DecompressorListener listener) throws IOException, DataFormatException {
+		CountingBitInputStream counter = input instanceof PeekableBitInputStream
+			? new CountingPeekableBitInputStream((PeekableBitInputStream)input)
+			: new CountingBitInputStream(input);
+		input = counter;
+		BlockStatistics stats = new BlockStatistics();
+		boolean isFinal;
+		do {
+			stats.clear();
+			long startBits = counter.bitCount;
+			isFinal = input.readNoEof() == 1;  // bfinal
+			int type = readInt(2, input);  // btype
+			stats.blockType = type;
+			
+			long startTime = System.nanoTime();
+			if (type == 0)
+				stats.uncompressedBytes = decompressUncompressedBlock();
 			else if (type == 1)
-				decompressHuffmanBlock(FIXED_LITERAL_LENGTH_CODE, FIXED_DISTANCE_CODE);
+				decompressHuffmanBlock(FIXED_LITERAL_LENGTH_CODE, FIXED_DISTANCE_CODE, stats);
 			else if (type == 2) {
-				CanonicalCode[] litLenAndDist = decodeHuffmanCodes();
-				decompressHuffmanBlock(litLenAndDist[0], litLenAndDist[1]);
+				long headerStartBits = counter.bitCount;
+				CanonicalCode[] litLenAndDist = decodeHuffmanCodes(input, cache);
+				stats.headerBits = counter.bitCount - headerStartBits;
+				long bodyStartTime = System.nanoTime();
+				stats.headerNanos = bodyStartTime - startTime;
+				startTime = bodyStartTime;
+				decompressHuffmanBlock(litLenAndDist[0], litLenAndDist[1], stats);
 			} else if (type == 3)
 				throw new DataFormatException("Reserved block type");
 			else
 				throw new AssertionError("Impossible value");
+			stats.bodyNanos = System.nanoTime() - startTime;
+			stats.compressedBits = counter.bitCount - startBits;
+			listener.blockDecoded(stats);
 		} while (!isFinal);
 	}
 	
 	
+	// Decompresses through a window that checks the limits before each piece of output. The input
+	// is wrapped to count the bits consumed only if the ratio is limited, since that costs a little.
+	private static void decompressLimited(BitInputStream in, OutputWindow out, DecompressionLimits limits) throws IOException, DataFormatException {
+		Objects.requireNonNull(in);
+		Objects.requireNonNull(limits);
+		CountingBitInputStream counter = null;
+		if (limits.maxRatio != Double.POSITIVE_INFINITY) {
+			counter = in instanceof PeekableBitInputStream
+				? new CountingPeekableBitInputStream((PeekableBitInputStream)in)
+				: new CountingBitInputStream(in);
+			in = counter;
+		}
+		new Decompressor(in, new LimitedOutputWindow(out, limits, counter), null);
+	}
+	
+	
+	// Each thread reuses one cache across all the streams it decompresses through the static functions.
+	private static final ThreadLocal<HuffmanTableCache> THREAD_CACHE = new ThreadLocal<HuffmanTableCache>() {
+		protected HuffmanTableCache initialValue() {
+			return new HuffmanTableCache();
+		}
+	};
+	
+	
 	/*-- The constant code trees for static Huffman codes (btype = 1) --*/
 	
-	private static final CanonicalCode FIXED_LITERAL_LENGTH_CODE;
-	private static final CanonicalCode FIXED_DISTANCE_CODE;
+	static final CanonicalCode FIXED_LITERAL_LENGTH_CODE;
+	static final CanonicalCode FIXED_DISTANCE_CODE;
 	
 	static {  // Make temporary tables of canonical code lengths
 		int[] llcodelens = new int[288];
@@ -107,38 +283,121 @@ public final class Decompressor {
 	}
 	
 	
+	/* 
+	 * Translation tables for the symbols of any code, indexed by the length symbol minus 257 (for all
+	 * 31 symbols that a literal/length code can have above 256) or by the distance symbol (for all 32).
+	 * Each entry packs (value << 16) | (kind << 8) | (numExtraBits << 4) with the kinds described below,
+	 * and the fused tables add the code length in the low bits.
+	 */
+	static final int[] LENGTH_SYMBOL_TABLE = new int[288 - 257];
+	static final int[] DISTANCE_SYMBOL_TABLE = new int[32];
+	
+	
+	/* 
+	 * Fused decoding tables for the fixed Huffman codes, indexed by the next 9 (or 5) bits of the
+	 * stream. Each entry describes the symbol whose code starts those bits, already translated to
+	 * the value it stands for, and packs (value << 16) | (kind << 8) | (numExtraBits << 4) | codeLength:
+	 * - KIND_LITERAL: value is the literal byte.
+	 * - KIND_BASE: value is the base run length or base distance, to which the next numExtraBits bits are added.
+	 * - KIND_END_OF_BLOCK: value is unused.
+	 * - KIND_RESERVED: value is the reserved symbol, which is invalid in a stream.
+	 */
+	private static final int[] FIXED_LITERAL_LENGTH_TABLE = new int[1 << 9];
+	private static final int[] FIXED_DISTANCE_TABLE = new int[1 << 5];
+	
+	static final int KIND_LITERAL      = 0;
+	static final int KIND_BASE         = 1;
+	static final int KIND_END_OF_BLOCK = 2;
+	static final int KIND_RESERVED     = 3;
+	
+	static {
+		for (int sym = 257; sym < 288; sym++) {  // Same formulas as decodeRunLength()
+			int value, kind = KIND_BASE, numExtraBits = 0;
+			if (sym <= 264)
+				value = sym - 254;
+			else if (sym <= 284) {
+				numExtraBits = (sym - 261) / 4;
+				value = (((sym - 265) % 4 + 4) << numExtraBits) + 3;
+			} else if (sym == 285)
+				value = 258;
+			else {
+				value = sym;
+				kind = KIND_RESERVED;
+			}
+			LENGTH_SYMBOL_TABLE[sym - 257] = value << 16 | kind << 8 | numExtraBits << 4;
+		}
+		
+		for (int sym = 0; sym < 32; sym++) {  // Same formulas as decodeDistance()
+			int value, kind = KIND_BASE, numExtraBits = 0;
+			if (sym <= 3)
+				value = sym + 1;
+			else if (sym <= 29) {
+				numExtraBits = sym / 2 - 1;
+				value = ((sym % 2 + 2) << numExtraBits) + 1;
+			} else {
+				value = sym;
+				kind = KIND_RESERVED;
+			}
+			DISTANCE_SYMBOL_TABLE[sym] = value << 16 | kind << 8 | numExtraBits << 4;
+		}
+	}
+	
+	static {
+		for (int i = 0; i < FIXED_LITERAL_LENGTH_TABLE.length; i++) {
+			int entry = FIXED_LITERAL_LENGTH_CODE.lookup(i);
+			int sym = entry >>> 4;
+			int info;
+			if (sym < 256)
+				info = sym << 16 | KIND_LITERAL << 8;
+			else if (sym == 256)
+				info = KIND_END_OF_BLOCK << 8;
+			else
+				info = LENGTH_SYMBOL_TABLE[sym - 257];
+			FIXED_LITERAL_LENGTH_TABLE[i] = info | (entry & 0xF);
+		}
+		for (int i = 0; i < FIXED_DISTANCE_TABLE.length; i++) {
+			int entry = FIXED_DISTANCE_CODE.lookup(i);
+			FIXED_DISTANCE_TABLE[i] = DISTANCE_SYMBOL_TABLE[entry >>> 4] | (entry & 0xF);
+		}
+	}
+	
+	
 	/*-- Method for reading and decoding dynamic Huffman codes (btype = 2) --*/
 	
-	// Reads from the bit input stream, decodes the Huffman code
-	// specifications into code trees, and returns the trees.
-	private CanonicalCode[] decodeHuffmanCodes() throws IOException, DataFormatException {
-		int numLitLenCodes = readInt(5) + 257;  // hlit + 257
-		int numDistCodes = readInt(5) + 1;      // hdist + 1
+	// Reads from the bit input stream, decodes the Huffman code specifications into code trees, and returns
+	// the trees. The cache's scratch arrays are used for the code lengths, and codes whose lengths
+	// match a recently built code are taken from the cache instead of being rebuilt. The returned
+	// array belongs to the cache and is overwritten by the next call, so nothing is allocated on a hit.
+	static CanonicalCode[] decodeHuffmanCodes(BitInputStream in, HuffmanTableCache cache) throws IOException, DataFormatException {
+		int numLitLenCodes = readInt(5, in) + 257;  // hlit + 257
+		int numDistCodes = readInt(5, in) + 1;      // hdist + 1
 		
 		// Read the code length code lengths
-		int numCodeLenCodes = readInt(4) + 4;   // hclen + 4
-		int[] codeLenCodeLen = new int[19];  // This array is filled in a strange order
-		codeLenCodeLen[16] = readInt(3);
-		codeLenCodeLen[17] = readInt(3);
-		codeLenCodeLen[18] = readInt(3);
-		codeLenCodeLen[ 0] = readInt(3);
+		int numCodeLenCodes = readInt(4, in) + 4;   // hclen + 4
+		int[] codeLenCodeLen = cache.codeLenCodeLen;  // This array is filled in a strange order
+		Arrays.fill(codeLenCodeLen, 0);
+		codeLenCodeLen[16] = readInt(3, in);
+		codeLenCodeLen[17] = readInt(3, in);
+		codeLenCodeLen[18] = readInt(3, in);
+		codeLenCodeLen[ 0] = readInt(3, in);
 		for (int i = 0; i < numCodeLenCodes - 4; i++) {
 			int j = (i % 2 == 0) ? (8 + i / 2) : (7 - i / 2);
-			codeLenCodeLen[j] = readInt(3);
+			codeLenCodeLen[j] = readInt(3, in);
 		}
 		
 		// Create the code length code
 		CanonicalCode codeLenCode;
 		try {
-			codeLenCode = new CanonicalCode(codeLenCodeLen);
+			codeLenCode = cache.get(codeLenCodeLen, 0, codeLenCodeLen.length);
 		} catch (IllegalArgumentException e) {
 			throw new DataFormatException(e.getMessage());
 		}
 		
 		// Read the main code lengths and handle runs
-		int[] codeLens = new int[numLitLenCodes + numDistCodes];
-		for (int codeLensIndex = 0; codeLensIndex < codeLens.length; ) {
-			int sym = codeLenCode.decodeNextSymbol(input);
+		int[] codeLens = cache.codeLens;
+		int numCodeLens = numLitLenCodes + numDistCodes;
+		for (int codeLensIndex = 0; codeLensIndex < numCodeLens; ) {
+			int sym = codeLenCode.decodeNextSymbol(in);
 			if (0 <= sym && sym <= 15) {
 				codeLens[codeLensIndex] = sym;
 				codeLensIndex++;
@@ -148,16 +407,16 @@ public final class Decompressor {
 				if (sym == 16) {
 					if (codeLensIndex == 0)
 						throw new DataFormatException("No code length value to copy");
-					runLen = readInt(2) + 3;
+					runLen = readInt(2, in) + 3;
 					runVal = codeLens[codeLensIndex - 1];
 				} else if (sym == 17)
-					runLen = readInt(3) + 3;
+					runLen = readInt(3, in) + 3;
 				else if (sym == 18)
-					runLen = readInt(7) + 11;
+					runLen = readInt(7, in) + 11;
 				else
 					throw new AssertionError("Symbol out of range");
 				int end = codeLensIndex + runLen;
-				if (end > codeLens.length)
+				if (end > numCodeLens)
 					throw new DataFormatException("Run exceeds number of codes");
 				Arrays.fill(codeLens, codeLensIndex, end, runVal);
 				codeLensIndex = end;
@@ -165,69 +424,84 @@ public final class Decompressor {
 		}
 		
 		// Create literal-length code tree
-		int[] litLenCodeLen = Arrays.copyOf(codeLens, numLitLenCodes);
 		CanonicalCode litLenCode;
 		try {
-			litLenCode = new CanonicalCode(litLenCodeLen);
+			litLenCode = cache.get(codeLens, 0, numLitLenCodes);
 		} catch (IllegalArgumentException e) {
 			throw new DataFormatException(e.getMessage());
 		}
 		
 		// Create distance code tree with some extra processing
-		int[] distCodeLen = Arrays.copyOfRange(codeLens, numLitLenCodes, codeLens.length);
 		CanonicalCode distCode;
-		if (distCodeLen.length == 1 && distCodeLen[0] == 0)
+		if (numDistCodes == 1 && codeLens[numLitLenCodes] == 0)
 			distCode = null;  // Empty distance code; the block shall be all literal symbols
 		else {
 			// Get statistics for upcoming logic
 			int oneCount = 0;
 			int otherPositiveCount = 0;
-			for (int x : distCodeLen) {
+			for (int i = numLitLenCodes; i < numCodeLens; i++) {
+				int x = codeLens[i];
 				if (x == 1)
 					oneCount++;
 				else if (x > 1)
 					otherPositiveCount++;
 			}
 			
-			// Handle the case where only one distance code is defined
-			if (oneCount == 1 && otherPositiveCount == 0) {
-				// Add a dummy invalid code to make the Huffman tree complete
-				distCodeLen = Arrays.copyOf(distCodeLen, 32);
-				distCodeLen[31] = 1;
-			}
 			try {
-				distCode = new CanonicalCode(distCodeLen);
+				// Handle the case where only one distance code is defined
+				if (oneCount == 1 && otherPositiveCount == 0) {
+					// Add a dummy invalid code to make the Huffman tree complete
+					int[] distCodeLen = Arrays.copyOfRange(codeLens, numLitLenCodes, numLitLenCodes + 32);
+					Arrays.fill(distCodeLen, numDistCodes, 32, 0);
+					distCodeLen[31] = 1;
+					distCode = cache.get(distCodeLen, 0, distCodeLen.length);
+				} else
+					distCode = cache.get(codeLens, numLitLenCodes, numDistCodes);
 			} catch (IllegalArgumentException e) {
 				throw new DataFormatException(e.getMessage());
 			}
 		}
 		
-		return new CanonicalCode[]{litLenCode, distCode};
+		CanonicalCode[] result = cache.decodedCodes;
+		result[0] = litLenCode;
+		result[1] = distCode;
+		return result;
 	}
 	
 	
 	/*-- Block decompression methods --*/
 	
-	// Handles and copies an uncompressed block from the bit input stream.
-	private void decompressUncompressedBlock() throws IOException, DataFormatException {
+	// Handles and copies an uncompressed block from the bit input stream, returning its length.
+	private int decompressUncompressedBlock() throws IOException, DataFormatException {
+		PeekableBitInputStream pin = input instanceof PeekableBitInputStream ? (PeekableBitInputStream)input : null;
+		
 		// Discard bits to align to byte boundary
-		while (input.getBitPosition() != 0)
-			input.readNoEof();
+		if (pin != null)
+			pin.consumeBits(-pin.getBitPosition() & 7);
+		else {
+			while (input.getBitPosition() != 0)
+				input.readNoEof();
+		}
 		
 		// Read length
-		int len  = readInt(16);
-		int nlen = readInt(16);
+		int len  = readInt(16, input);
+		int nlen = readInt(16, input);
 		if ((len ^ 0xFFFF) != nlen)
 			throw new DataFormatException("Invalid length in uncompressed block");
 		
-		// Copy bytes
-		for (int i = 0; i < len; i++) {
-			int b = input.readByte();
-			if (b == -1)
+		// Copy bytes, in bulk straight from the input into the output if possible
+		if (pin != null) {
+			if (output.appendFrom(pin, len) != len)
 				throw new EOFException();
-			output.write(b);
-			dictionary.append(b);
+		} else {
+			for (int i = 0; i < len; i++) {
+				int b = input.readByte();
+				if (b == -1)
+					throw new EOFException();
+				output.append(b);
+			}
 		}
+		return len;
 	}
 	
 	
@@ -236,6 +510,139 @@ public final class Decompressor {
 			throws IOException, DataFormatException {
 		Objects.requireNonNull(litLenCode);
 		// distCode is allowed to be null
+		if (input instanceof PeekableBitInputStream) {
+			// Check once per block that the alphabets fit the symbol tables, so the loops need no checks per symbol
+			if (litLenCode.getSymbolLimit() > 288 || distCode != null && distCode.getSymbolLimit() > 32)
+				throw new AssertionError("Alphabet too large");
+			PeekableBitInputStream in = (PeekableBitInputStream)input;
+			if (distCode == null)
+				decompressLiteralHuffmanBlock(in, litLenCode);
+			else
+				decompressDynamicHuffmanBlock(in, cache.getBlockTable(litLenCode, distCode));
+			return;
+		}
+		
+		while (true) {
+			int sym = litLenCode.decodeNextSymbol(input);
+			if (sym == 256)  // End of block
+				break;
+			
+			if (sym < 256)  // Literal byte
+				output.append(sym);
+			else {  // Length and distance for copying
+				int run = decodeRunLength(sym, input);
+				if (run < 3 || run > 258)
+					throw new AssertionError("Invalid run length");
+				if (distCode == null)
+					throw new DataFormatException("Length symbol encountered with empty distance code");
+				int distSym = distCode.decodeNextSymbol(input);
+				int dist = decodeDistance(distSym, input);
+				if (dist < 1 || dist > 32768)
+					throw new AssertionError("Invalid distance");
+				output.copy(dist, run);
+			}
+		}
+	}
+	
+	
+	// Does the same as decompressHuffmanBlock(litLenCode, distCode) for a peekable stream and a block with
+	// a distance code, using the codes' fused tables. Literal-heavy data is sped up by first trying the literal
+	// pair entry, which decodes two literals with one lookup and shares a cache line with the symbol entry.
+	// A length code and its extra bits take at most 15 + 5 = 20 bits, and a distance code and its extra
+	// bits at most 15 + 13 = 28 bits, so each takes a single peek.
+	private void decompressDynamicHuffmanBlock(PeekableBitInputStream in, BlockDecodeTable codes)
+			throws IOException, DataFormatException {
+		int[] table = codes.table;
+		int litLenBits = codes.litLenBits;
+		int litLenMask = (1 << litLenBits) - 1;
+		int distStart = codes.distStart;
+		int distBits = codes.distBits;
+		int distMask = (1 << distBits) - 1;
+		while (true) {
+			int bits = in.peekBits(32);
+			int index = (bits & litLenMask) << 1;
+			int pair = table[index];
+			if (pair != 0) {  // Two literal bytes
+				in.consumeBits(pair & 0x1F);
+				output.append((pair >>> 8) & 0xFF);
+				output.append(pair >>> 16);
+				continue;
+			}
+			
+			int entry = table[index + 1];
+			if ((entry & 0xF) == 0)  // Link to a subtable
+				entry = table[(entry >>> 16) + ((bits >>> litLenBits) & ((1 << ((entry >>> 4) & 0xF)) - 1))];
+			int used = entry & 0xF;
+			int kind = (entry >>> 8) & 3;
+			
+			if (kind == KIND_LITERAL) {
+				in.consumeBits(used);
+				output.append(entry >>> 16);
+			} else if (kind == KIND_BASE) {  // Length and distance for copying
+				int numExtraBits = (entry >>> 4) & 0xF;
+				int run = (entry >>> 16) + ((bits >>> used) & ((1 << numExtraBits) - 1));
+				in.consumeBits(used + numExtraBits);
+				
+				bits = in.peekBits(32);
+				entry = table[distStart + (bits & distMask)];
+				if ((entry & 0xF) == 0)  // Link to a subtable
+					entry = table[(entry >>> 16) + ((bits >>> distBits) & ((1 << ((entry >>> 4) & 0xF)) - 1))];
+				used = entry & 0xF;
+				if (((entry >>> 8) & 3) == KIND_RESERVED) {
+					in.consumeBits(used);
+					throw new DataFormatException("Reserved distance symbol: " + (entry >>> 16));
+				}
+				numExtraBits = (entry >>> 4) & 0xF;
+				int dist = (entry >>> 16) + ((bits >>> used) & ((1 << numExtraBits) - 1));
+				in.consumeBits(used + numExtraBits);  // Throws EOFException if the peeked bits ran past the end of stream
+				output.copy(dist, run);
+			} else if (kind == KIND_END_OF_BLOCK) {
+				in.consumeBits(used);
+				break;
+			} else {
+				in.consumeBits(used);
+				throw new DataFormatException("Reserved length symbol: " + (entry >>> 16));
+			}
+		}
+	}
+	
+	
+	// Does the same as decompressHuffmanBlock(litLenCode, null) for a peekable stream. A block whose
+	// distance code is empty can only hold literals, so the loop has no match path at all.
+	private void decompressLiteralHuffmanBlock(PeekableBitInputStream in, CanonicalCode litLenCode)
+			throws IOException, DataFormatException {
+		while (true) {
+			int bits = in.peekBits(15);
+			int pair = litLenCode.lookupLiteralPair(bits);
+			if (pair != 0) {  // Two literal bytes
+				in.consumeBits(pair & 0x1F);
+				output.append((pair >>> 8) & 0xFF);
+				output.append(pair >>> 16);
+				continue;
+			}
+			
+			int entry = litLenCode.lookup(bits);
+			in.consumeBits(entry & 0xF);
+			int sym = entry >>> 4;
+			if (sym < 256)  // Literal byte
+				output.append(sym);
+			else if (sym == 256)  // End of block
+				break;
+			else if (sym <= 285)
+				throw new DataFormatException("Length symbol encountered with empty distance code");
+			else
+				throw new DataFormatException("Reserved length symbol: " + sym);
+		}
+	}
+	
+	
+	// Does the same as decompressHuffmanBlock(litLenCode, distCode), and also counts
+	// the block's symbols into the given statistics. Kept separate so that the
+	// uninstrumented loop has no extra work per symbol.
+	private void decompressHuffmanBlock(CanonicalCode litLenCode, CanonicalCode distCode, BlockStatistics stats)
+			throws IOException, DataFormatException {
+		Objects.requireNonNull(litLenCode);
+		// distCode is allowed to be null
 		
 		while (true) {
 			int sym = litLenCode.decodeNextSymbol(input);
@@ -243,19 +650,65 @@ public final class Decompressor {
 				break;
 			
 			if (sym < 256) {  // Literal byte
-				output.write(sym);
-				dictionary.append(sym);
+				output.append(sym);
+				stats.literalCount++;
 			} else {  // Length and distance for copying
-				int run = decodeRunLength(sym);
+				int run = decodeRunLength(sym, input);
 				if (run < 3 || run > 258)
 					throw new AssertionError("Invalid run length");
 				if (distCode == null)
 					throw new DataFormatException("Length symbol encountered with empty distance code");
 				int distSym = distCode.decodeNextSymbol(input);
-				int dist = decodeDistance(distSym);
+				int dist = decodeDistance(distSym, input);
 				if (dist < 1 || dist > 32768)
 					throw new AssertionError("Invalid distance");
-				dictionary.copy(dist, run, output);
+				output.copy(dist, run);
+				stats.matchCount++;
+				stats.matchLengthHistogram[run]++;
+				stats.distanceSymbolHistogram[distSym]++;
+				stats.uncompressedBytes += run;
+			}
+		}
+		stats.uncompressedBytes += stats.literalCount;
+	}
+	
+	
+	// Decompresses a block coded with the fixed Huffman codes using the fused tables. A length code,
+	// its extra bits, the distance code and its extra bits take at most 8 + 5 + 5 + 13 = 31 bits,
+	// so each literal or whole (length, distance) pair is decoded from a single peek.
+	private void decompressFixedHuffmanBlock(PeekableBitInputStream in) throws IOException, DataFormatException {
+		while (true) {
+			int bits = in.peekBits(32);
+			int entry = FIXED_LITERAL_LENGTH_TABLE[bits & 0x1FF];
+			int used = entry & 0xF;
+			int kind = (entry >>> 8) & 3;
+			
+			if (kind == KIND_LITERAL) {
+				in.consumeBits(used);
+				output.append(entry >>> 16);
+			} else if (kind == KIND_BASE) {  // Length and distance for copying
+				int numExtraBits = (entry >>> 4) & 0xF;
+				int run = (entry >>> 16) + ((bits >>> used) & ((1 << numExtraBits) - 1));
+				used += numExtraBits;
+				
+				int distEntry = FIXED_DISTANCE_TABLE[(bits >>> used) & 0x1F];
+				used += distEntry & 0xF;
+				if (((distEntry >>> 8) & 3) == KIND_RESERVED) {
+					in.consumeBits(used);
+					throw new DataFormatException("Reserved distance symbol: " + (distEntry >>> 16));
+				}
+				numExtraBits = (distEntry >>> 4) & 0xF;
+				int dist = (distEntry >>> 16) + ((bits >>> used) & ((1 << numExtraBits) - 1));
+				used += numExtraBits;
+				
+				in.consumeBits(used);  // Throws EOFException if the peeked bits ran past the end of stream
+				output.copy(dist, run);
+			} else if (kind == KIND_END_OF_BLOCK) {
+				in.consumeBits(used);
+				break;
+			} else {
+				in.consumeBits(used);
+				throw new DataFormatException("Reserved length symbol: " + (entry >>> 16));
 			}
 		}
 	}
@@ -264,14 +717,14 @@ public final class Decompressor {
 	/*-- Symbol decoding methods --*/
 	
 	// Returns the run length based on the given symbol and possibly reading more bits.
-	private int decodeRunLength(int sym) throws IOException, DataFormatException {
+	static int decodeRunLength(int sym, BitInputStream in) throws IOException, DataFormatException {
 		if (sym < 257 || sym > 287)  // Cannot occur in the bit stream; indicates the decompressor is buggy
 			throw new AssertionError("Invalid run length symbol: " + sym);
 		else if (sym <= 264)
 			return sym - 254;
 		else if (sym <= 284) {
 			int numExtraBits = (sym - 261) / 4;
-			return (((sym - 265) % 4 + 4) << numExtraBits) + 3 + readInt(numExtraBits);
+			return (((sym - 265) % 4 + 4) << numExtraBits) + 3 + readInt(numExtraBits, in);
 		} else if (sym == 285)
 			return 258;
 		else  // sym is 286 or 287
@@ -280,14 +733,14 @@ public final class Decompressor {
 	
 	
 	// Returns the distance based on the given symbol and possibly reading more bits.
-	private int decodeDistance(int sym) throws IOException, DataFormatException {
+	static int decodeDistance(int sym, BitInputStream in) throws IOException, DataFormatException {
 		if (sym < 0 || sym > 31)  // Cannot occur in the bit stream; indicates the decompressor is buggy
 			throw new AssertionError("Invalid distance symbol: " + sym);
 		if (sym <= 3)
 			return sym + 1;
 		else if (sym <= 29) {
 			int numExtraBits = sym / 2 - 1;
-			return ((sym % 2 + 2) << numExtraBits) + 1 + readInt(numExtraBits);
+			return ((sym % 2 + 2) << numExtraBits) + 1 + readInt(numExtraBits, in);
 		} else  // sym is 30 or 31
 			throw new DataFormatException("Reserved distance symbol: " + sym);
 	}
@@ -296,13 +749,167 @@ public final class Decompressor {
 	/*-- Utility method --*/
 	
 	// Reads the given number of bits from the bit input stream as a single integer, packed in little endian.
-	private int readInt(int numBits) throws IOException {
+	static int readInt(int numBits, BitInputStream in) throws IOException {
 		if (numBits < 0 || numBits > 31)
 			throw new IllegalArgumentException();
+		if (in instanceof PeekableBitInputStream)
+			return ((PeekableBitInputStream)in).readBits(numBits);
 		int result = 0;
 		for (int i = 0; i < numBits; i++)
-			result |= input.readNoEof() << i;
+			result |= in.readNoEof() << i;
 		return result;
 	}
 	
+	
+	/*-- Bit counting wrappers for statistics --*/
+	
+	// Passes through a bit input stream, counting the bits consumed from it. Package-private for ZlibDecompressor.
+	static class CountingBitInputStream implements BitInputStream {
+		
+		private final BitInputStream in;
+		public long bitCount = 0;
+		
+		
+		public CountingBitInputStream(BitInputStream in) {
+			this.in = in;
+		}
+		
+		
+		public int getBitPosition() {
+			return in.getBitPosition();
+		}
+		
+		
+		public int readByte() throws IOException {
+			int skipped = (8 - in.getBitPosition()) & 7;
+			int result = in.readByte();
+			if (result != -1)
+				bitCount += skipped + 8;
+			return result;
+		}
+		
+		
+		public int read() throws IOException {
+			int result = in.read();
+			if (result != -1)
+				bitCount++;
+			return result;
+		}
+		
+		
+		public int readNoEof() throws IOException {
+			int result = in.readNoEof();
+			bitCount++;
+			return result;
+		}
+		
+		
+		public void close() throws IOException {
+			in.close();
+		}
+		
+	}
+	
+	
+	// Passes through a peekable bit input stream, so that table-driven decoding still applies.
+	private static final class CountingPeekableBitInputStream extends CountingBitInputStream implements PeekableBitInputStream {
+		
+		private final PeekableBitInputStream in;
+		
+		
+		public CountingPeekableBitInputStream(PeekableBitInputStream in) {
+			super(in);
+			this.in = in;
+		}
+		
+		
+		public int peekBits(int numBits) throws IOException {
+			return in.peekBits(numBits);
+		}
+		
+		
+		public void consumeBits(int numBits) throws IOException {
+			in.consumeBits(numBits);
+			bitCount += numBits;
+		}
+		
+		
+		public int readBits(int numBits) throws IOException {
+			int result = in.readBits(numBits);
+			bitCount += numBits;
+			return result;
+		}
+		
+		
+		public int readBytes(byte[] b, int off, int len) throws IOException {
+			int skipped = (8 - in.getBitPosition()) & 7;
+			int result = in.readBytes(b, off, len);
+			bitCount += skipped + result * 8L;
+			return result;
+		}
+		
+	}
+	
+	
+	/*-- Limit enforcing wrapper --*/
+	
+	// Passes through an output window, counting the output and throwing before any piece of it would exceed the limits.
+	private static final class LimitedOutputWindow implements OutputWindow {
+		
+		private final OutputWindow out;
+		private final long maxOutputBytes;
+		private final double maxRatio;
+		private final CountingBitInputStream input;  // Null if the ratio is unlimited
+		private long outputBytes = 0;
+		
+		
+		public LimitedOutputWindow(OutputWindow out, DecompressionLimits limits, CountingBitInputStream input) {
+			this.out = out;
+			maxOutputBytes = limits.maxOutputBytes;
+			maxRatio = limits.maxRatio;
+			this.input = input;
+		}
+		
+		
+		public void append(int b) throws IOException {
+			reserve(1, 0);
+			out.append(b);
+		}
+		
+		
+		public void append(byte[] b, int off, int len) throws IOException {
+			reserve(len, 0);
+			out.append(b, off, len);
+		}
+		
+		
+		public int appendFrom(PeekableBitInputStream in, int len) throws IOException {
+			// The stored bytes count as input too, but have not been consumed yet
+			reserve(len, len);
+			int result = out.appendFrom(in, len);
+			outputBytes -= len - result;
+			return result;
+		}
+		
+		
+		public void copy(int dist, int len) throws IOException {
+			reserve(len, 0);
+			out.copy(dist, len);
+		}
+		
+		
+		// Counts the given number of bytes about to be output, after checking them against the limits
+		// with the given number of input bytes that will be consumed for them but have not been yet.
+		private void reserve(int len, int pendingInput) throws DecompressionLimitException {
+			long total = outputBytes + len;
+			if (total > maxOutputBytes)
+				throw new DecompressionLimitException("Output exceeds " + maxOutputBytes + " bytes");
+			if (input != null && total > DecompressionLimits.RATIO_GRACE_BYTES
+					&& total > maxRatio * (((input.bitCount + 7) >>> 3) + pendingInput))
+				throw new DecompressionLimitException("Expansion ratio exceeds " + maxRatio);
+			outputBytes = total;
+		}
+		
+	}
+	
 }
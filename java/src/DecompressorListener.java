@@ -0,0 +1,25 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+
+/**
+ * Receives statistics about each block that {@link Decompressor} decodes, for
+ * finding out where decoding time goes. See {@link BlockStatistics} for what is reported.
+ * @see Decompressor#decompress(BitInputStream, java.io.OutputStream, DecompressorListener)
+ */
+public interface DecompressorListener {
+	
+	/**
+	 * Called after each block has been fully decoded and its output appended. The statistics object
+	 * is reused for the next block, so any values needed later must be copied out before returning.
+	 * If this throws an exception, decompression stops and the exception is propagated.
+	 * @param stats the statistics of the block just decoded (not {@code null})
+	 */
+	public void blockDecoded(BlockStatistics stats);
+	
+}
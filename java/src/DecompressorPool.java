@@ -0,0 +1,126 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.io.EOFException;
+import java.io.IOException;
+import java.util.Objects;
+import java.util.concurrent.ArrayBlockingQueue;
+import java.util.concurrent.BlockingQueue;
+import java.util.zip.DataFormatException;
+
+
+/**
+ * A bounded pool of reusable decompressors that take fed input, for services that decode many
+ * small DEFLATE streams. A decompressor is taken with {@link #acquire()} and given back with
+ * {@link #release(ResumableDecompressor)}; once the pool has warmed up, decoding a stream with
+ * {@link #decompress(byte[], int, int, byte[], int, int)} allocates nothing. Thread-safe
+ * (but each acquired decompressor must only be used by one thread at a time).
+ */
+public final class DecompressorPool {
+	
+	/*---- Fields ----*/
+	
+	// Idle decompressors, ready to be reset and reused.
+	private final BlockingQueue<ResumableDecompressor> idle;
+	
+	
+	
+	/*---- Constructor ----*/
+	
+	/**
+	 * Constructs an empty pool that keeps at most the specified number of idle decompressors.
+	 * Decompressors are created on demand, and ones released to a full pool are discarded.
+	 * @param maxIdle the maximum number of idle decompressors to keep, which must be positive
+	 * @throws IllegalArgumentException if the maximum is not positive
+	 */
+	public DecompressorPool(int maxIdle) {
+		if (maxIdle < 1)
+			throw new IllegalArgumentException("Maximum must be positive");
+		idle = new ArrayBlockingQueue<>(maxIdle);
+	}
+	
+	
+	
+	/*---- Methods ----*/
+	
+	/**
+	 * Returns a decompressor from this pool (or a new one if none is idle), reset and ready to be fed a new stream.
+	 * @return a decompressor that takes fed input (not {@code null})
+	 */
+	public ResumableDecompressor acquire() {
+		ResumableDecompressor result = idle.poll();
+		if (result == null)
+			return new ResumableDecompressor();
+		result.reset();
+		return result;
+	}
+	
+	
+	/**
+	 * Returns the specified decompressor to this pool, after which the caller must not use it.
+	 * It may be in any state, even after an exception. It is discarded if the pool is full.
+	 * @param decomp a decompressor that takes fed input (not {@code null})
+	 * @throws NullPointerException if the decompressor is {@code null}
+	 */
+	public void release(ResumableDecompressor decomp) {
+		idle.offer(Objects.requireNonNull(decomp));
+	}
+	
+	
+	/**
+	 * Decompresses the whole raw DEFLATE stream in the specified input array range into the specified
+	 * output array range, using a decompressor from this pool. Bytes after the end of the stream are
+	 * ignored. Returns the number of bytes written. The contents of the output range after that count
+	 * are unspecified when an exception is thrown, and also when this method returns.
+	 * @param src the array holding the DEFLATE data (not {@code null})
+	 * @param srcOff the index of the first byte of the DEFLATE data
+	 * @param srcLen the number of input bytes available
+	 * @param dst the array to write the decompressed data to (not {@code null})
+	 * @param dstOff the index in the output array to write the first byte to
+	 * @param dstLen the maximum number of bytes to write
+	 * @return the number of bytes written, between 0 and {@code dstLen}
+	 * @throws NullPointerException if an array is {@code null}
+	 * @throws IndexOutOfBoundsException if an array range is out of bounds
+	 * @throws EOFException if the input range ends before the DEFLATE data does
+	 * @throws DataFormatException if the DEFLATE data is malformed,
+	 * or if the decompressed data does not fit in the output range
+	 */
+	public int decompress(byte[] src, int srcOff, int srcLen, byte[] dst, int dstOff, int dstLen) throws IOException, DataFormatException {
+		Objects.requireNonNull(src);
+		Objects.requireNonNull(dst);
+		if (dstOff < 0 || dstLen < 0 || dstOff > dst.length - dstLen)
+			throw new IndexOutOfBoundsException();
+		
+		ResumableDecompressor decomp = acquire();
+		try {
+			decomp.feed(src, srcOff, srcLen);
+			int result = Math.max(decomp.decompress(dst, dstOff, dstLen), 0);
+			if (result == dstLen && !decomp.isFinished()) {
+				// The output is full, so check that nothing but the end of the stream remains,
+				// by decoding one more byte into the last position and then restoring it
+				byte[] probe = dst;
+				int probeOff = dstOff + dstLen - 1;
+				if (dstLen == 0) {
+					probe = new byte[1];
+					probeOff = 0;
+				}
+				byte saved = probe[probeOff];
+				boolean overflow = decomp.decompress(probe, probeOff, 1) > 0;
+				probe[probeOff] = saved;
+				if (overflow)
+					throw new DataFormatException("Decompressed data exceeds output buffer");
+			}
+			if (!decomp.isFinished())
+				throw new EOFException();
+			return result;
+		} finally {
+			release(decomp);
+		}
+	}
+	
+}
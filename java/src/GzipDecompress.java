@@ -6,27 +6,62 @@
  * https://github.com/nayuki/Simple-DEFLATE-decompressor
  */
 
-import java.io.BufferedInputStream;
 import java.io.ByteArrayOutputStream;
-import java.io.DataInput;
-import java.io.DataInputStream;
+import java.io.EOFException;
 import java.io.File;
-import java.io.FileInputStream;
+import java.io.FilterOutputStream;
 import java.io.IOException;
+import java.io.InputStream;
+import java.io.OutputStream;
+import java.io.PrintStream;
+import java.nio.ByteBuffer;
+import java.nio.channels.Channels;
+import java.nio.channels.FileChannel;
 import java.nio.charset.StandardCharsets;
 import java.nio.file.Files;
 import java.nio.file.Path;
 import java.nio.file.Paths;
+import java.nio.file.StandardOpenOption;
+import java.util.ArrayDeque;
+import java.util.ArrayList;
+import java.util.Arrays;
 import java.util.Date;
+import java.util.List;
+import java.util.Queue;
+import java.util.concurrent.Callable;
+import java.util.concurrent.CancellationException;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.Future;
+import java.util.concurrent.atomic.AtomicBoolean;
 import java.util.zip.CRC32;
 import java.util.zip.DataFormatException;
 
 
 /**
  * Decompression application for the gzip file format.
- * <p>Usage: java GzipDecompress InputFile.gz OutputFile</p>
+ * <p>Usage: java GzipDecompress [-j Threads | -p] InputFile.gz OutputFile<br>
+ * &nbsp;&nbsp;or: java GzipDecompress -t InputFile.gz<br>
+ * &nbsp;&nbsp;or: java GzipDecompress -b [-q] [-j Threads] (InputDir OutputDir | InputFile.gz OutputFile ...)</p>
  * <p>This decompresses a single gzip input file into a single output file. The program also prints
- * some information to standard output, and error messages if the file is invalid/corrupt.</p>
+ * some information to standard output, and error messages if the file is invalid/corrupt.
+ * All members of a multi-member file are decompressed and concatenated. Like gzip, any trailing data
+ * after the last member that does not start another one (such as zero padding) is ignored with a warning.
+ * With more than one thread, a BGZF file (whose members record their own sizes) has its members decoded in
+ * parallel; any other file up to 2 GiB has each member decoded speculatively in parallel
+ * by {@link ParallelDecompressor}, and a larger file is decoded sequentially.</p>
+ * <p>With -p, the file is instead decoded in a pipeline of three threads, for storage whose latency
+ * is comparable to the decoding time: one reads the input ahead, one decodes and checks the
+ * CRC-32, and one writes the output. The stages pass recycled arrays through lock-free rings.</p>
+ * <p>With -t, the file is only tested: every member is decoded and its CRC-32 and length are checked,
+ * but the output is neither stored nor written, so memory use is just the 32 KiB window.</p>
+ * <p>With -b, many files are decompressed in one run, which saves starting and warming up a JVM for
+ * each one: either the listed pairs of input and output files, or every *.gz file in the input directory
+ * into the output directory without the extension. The files are decoded concurrently on a pool
+ * of the given number of threads (by default one per processor), each file on a single thread.
+ * A file that fails is reported and skipped. The header information of each file is printed in
+ * order unless -q is given, and the total sizes and throughput are printed at the end.</p>
  */
 public final class GzipDecompress {
 	
@@ -39,124 +74,794 @@ public final class GzipDecompress {
 	}
 	
 	
-	// Returns null if successful, otherwise returns an error message string.
-	private static String submain(String[] args) {
+	// Returns null if successful, otherwise returns an error message string. Package-private for the tests.
+	static String submain(String[] args) {
 		// Handle command line arguments
-		if (args.length != 2)
-			return "Usage: java GzipDecompress InputFile.gz OutputFile";
+		if (args.length > 0 && args[0].equals("-b"))
+			return submainBatch(Arrays.copyOfRange(args, 1, args.length));
+		int numThreads = 1;
+		boolean pipelined = false;
+		boolean testOnly = false;
+		if (args.length == 2 && args[0].equals("-t")) {
+			testOnly = true;
+			args = new String[]{args[1]};
+		} else if (args.length == 3 && args[0].equals("-p")) {
+			pipelined = true;
+			args = new String[]{args[1], args[2]};
+		} else if (args.length == 4 && args[0].equals("-j")) {
+			try {
+				numThreads = Integer.parseInt(args[1]);
+			} catch (NumberFormatException e) {
+				return USAGE;
+			}
+			if (numThreads < 1)
+				return USAGE;
+			args = new String[]{args[2], args[3]};
+		}
+		if (args.length != (testOnly ? 1 : 2))
+			return USAGE;
 		File inFile = new File(args[0]);
 		if (!inFile.exists())
 			return "Input file does not exist: " + inFile;
 		if (inFile.isDirectory())
 			return "Input file is a directory: " + inFile;
-		Path outFile = Paths.get(args[1]);
 		
 		try {
-			byte[] decomp;
-			int crc, size;
-			// Start reading
-			try (DataInputStream in = new DataInputStream(new BufferedInputStream(new FileInputStream(inFile), 16 * 1024))) {
-				// Header
-				int flags;
-				{
-					if (in.readUnsignedShort() != 0x1F8B)
-						return "Invalid GZIP magic number";
-					int compMeth = in.readUnsignedByte();
-					if (compMeth != 8)
-						return "Unsupported compression method: " + compMeth;
-					flags = in.readUnsignedByte();
-					
-					// Reserved flags
-					if ((flags & 0xE0) != 0)
-						return "Reserved flags are set";
-					
-					// Modification time
-					int mtime = readLittleEndianInt32(in);
-					if (mtime != 0)
-						System.out.println("Last modified: " + new Date(mtime * 1000L));
-					else
-						System.out.println("Last modified: N/A");
-					
-					// Extra flags
-					int extraFlags = in.readUnsignedByte();
-					switch (extraFlags) {
-						case 2:   System.out.println("Extra flags: Maximum compression");  break;
-						case 4:   System.out.println("Extra flags: Fastest compression");  break;
-						default:  System.out.println("Extra flags: Unknown (" + extraFlags + ")");  break;
-					}
-					
-					// Operating system
-					String os;
-					switch (in.readUnsignedByte()) {
-						case   0:  os = "FAT";             break;
-						case   1:  os = "Amiga";           break;
-						case   2:  os = "VMS";             break;
-						case   3:  os = "Unix";            break;
-						case   4:  os = "VM/CMS";          break;
-						case   5:  os = "Atari TOS";       break;
-						case   6:  os = "HPFS";            break;
-						case   7:  os = "Macintosh";       break;
-						case   8:  os = "Z-System";        break;
-						case   9:  os = "CP/M";            break;
-						case  10:  os = "TOPS-20";         break;
-						case  11:  os = "NTFS";            break;
-						case  12:  os = "QDOS";            break;
-						case  13:  os = "Acorn RISCOS";    break;
-						case 255:  os = "Unknown";         break;
-						default :  os = "Really unknown";  break;
+			if (testOnly) {
+				try (FileChannel channel = FileChannel.open(inFile.toPath(), StandardOpenOption.READ)) {
+					verifyMembers(channel);
+				}
+				return null;
+			}
+			
+			Path outFile = Paths.get(args[1]);
+			boolean success = false;
+			try (FileChannel channel = FileChannel.open(inFile.toPath(), StandardOpenOption.READ)) {
+				if (pipelined)
+					decompressPipelined(channel, outFile);
+				else if (numThreads > 1 && isBgzf(channel))
+					decompressBgzf(channel, outFile, numThreads);
+				else
+					decompressMembers(channel, outFile, numThreads, System.out);
+				success = true;
+			} finally {
+				if (!success)  // Don't leave partial or unverified output behind
+					Files.deleteIfExists(outFile);
+			}
+			
+		} catch (DataFormatException e) {
+			return e.getMessage();
+		} catch (IOException e) {
+			return "I/O exception: " + e.getMessage();
+		} catch (InterruptedException e) {
+			return "Interrupted";
+		}
+		return null;  // Success, no error message
+	}
+	
+	
+	// Handles the arguments after -b. Returns null if every file succeeded, otherwise returns an error message string.
+	private static String submainBatch(String[] args) {
+		// Handle options
+		boolean quiet = false;
+		int numThreads = Runtime.getRuntime().availableProcessors();
+		int argIndex = 0;
+		while (argIndex < args.length && args[argIndex].startsWith("-")) {
+			if (args[argIndex].equals("-q")) {
+				quiet = true;
+				argIndex++;
+			} else if (args[argIndex].equals("-j") && argIndex + 1 < args.length) {
+				try {
+					numThreads = Integer.parseInt(args[argIndex + 1]);
+				} catch (NumberFormatException e) {
+					return USAGE;
+				}
+				if (numThreads < 1)
+					return USAGE;
+				argIndex += 2;
+			} else
+				return USAGE;
+		}
+		args = Arrays.copyOfRange(args, argIndex, args.length);
+		
+		// Collect the pairs of files
+		List<File> inFiles = new ArrayList<>();
+		List<Path> outFiles = new ArrayList<>();
+		if (args.length == 2 && new File(args[0]).isDirectory()) {
+			File[] files = new File(args[0]).listFiles();
+			if (files == null)
+				return "Cannot list input directory: " + args[0];
+			Arrays.sort(files);
+			Path outDir = Paths.get(args[1]);
+			for (File f : files) {
+				String name = f.getName();
+				if (f.isFile() && name.endsWith(".gz") && name.length() > 3) {
+					inFiles.add(f);
+					outFiles.add(outDir.resolve(name.substring(0, name.length() - 3)));
+				}
+			}
+			try {
+				Files.createDirectories(outDir);
+			} catch (IOException e) {
+				return "I/O exception: " + e.getMessage();
+			}
+		} else if (args.length >= 2 && args.length % 2 == 0) {
+			for (int i = 0; i < args.length; i += 2) {
+				inFiles.add(new File(args[i]));
+				outFiles.add(Paths.get(args[i + 1]));
+			}
+		} else
+			return USAGE;
+		
+		// Decompress every file on the pool, reporting the results in order. This is not a fork-join pool,
+		// because depending on the JDK version, one wraps a task's checked exception in a RuntimeException.
+		ExecutorService pool = Executors.newFixedThreadPool(numThreads);
+		try {
+			long startTime = System.nanoTime();
+			List<Future<String>> results = new ArrayList<>();
+			for (int i = 0; i < inFiles.size(); i++) {
+				final File inFile = inFiles.get(i);
+				final Path outFile = outFiles.get(i);
+				final boolean printInfo = !quiet;
+				results.add(pool.submit(new Callable<String>() {
+					public String call() throws IOException, DataFormatException {
+						ByteArrayOutputStream bout = printInfo ? new ByteArrayOutputStream() : null;
+						PrintStream info = printInfo ? new PrintStream(bout, true, "UTF-8") : null;
+						decompressFile(inFile, outFile, info);
+						return printInfo ? bout.toString("UTF-8") : null;
 					}
-					System.out.println("Operating system: " + os);
+				}));
+			}
+			
+			int numFailed = 0;
+			long inputBytes = 0;
+			long outputBytes = 0;
+			for (int i = 0; i < inFiles.size(); i++) {
+				File inFile = inFiles.get(i);
+				try {
+					String info = getResult(results.get(i));
+					if (info != null)
+						System.out.print("== " + inFile + " ==" + System.lineSeparator() + info);
+					inputBytes += inFile.length();
+					outputBytes += Files.size(outFiles.get(i));
+				} catch (IOException e) {
+					System.err.println(inFile + ": I/O exception: " + e.getMessage());
+					numFailed++;
+				} catch (DataFormatException e) {
+					System.err.println(inFile + ": " + e.getMessage());
+					numFailed++;
+				} catch (RuntimeException e) {  // An unexpected failure of one file must not stop the batch
+					System.err.println(inFile + ": " + e);
+					numFailed++;
 				}
+			}
+			
+			double seconds = (System.nanoTime() - startTime) / 1e9;
+			System.out.printf("Files: %d, input: %d bytes, output: %d bytes, time: %.3f s, throughput: %.1f MB/s out (%.1f MB/s in)%n",
+				inFiles.size() - numFailed, inputBytes, outputBytes, seconds, outputBytes / seconds / 1e6, inputBytes / seconds / 1e6);
+			if (numFailed > 0)
+				return numFailed + " of " + inFiles.size() + " files failed";
+			return null;
+		} catch (InterruptedException e) {
+			return "Interrupted";
+		} finally {
+			pool.shutdownNow();
+		}
+	}
+	
+	
+	/*---- Decompression drivers ----*/
+	
+	// Decompresses one file sequentially for batch mode, printing its header information to the given stream
+	// unless it is null. Like the single-file mode, the output file is deleted if anything fails.
+	private static void decompressFile(File inFile, Path outFile, PrintStream info) throws IOException, DataFormatException {
+		boolean success = false;
+		try (FileChannel channel = FileChannel.open(inFile.toPath(), StandardOpenOption.READ)) {
+			decompressMembers(channel, outFile, 1, info);
+			success = true;
+		} finally {
+			if (!success)
+				Files.deleteIfExists(outFile);
+		}
+	}
+	
+	
+	
+	// Decompresses every member of the file in order, writing each piece to the output file and updating
+	// the checks as it is produced, so that memory use is bounded by the 32 KiB window and the I/O buffers.
+	// With more than one thread, each member is decoded in parallel straight from a memory-mapped view.
+	private static void decompressMembers(FileChannel channel, Path outFile, int numThreads, PrintStream info) throws IOException, DataFormatException {
+		// Start reading, in place from a memory-mapped view of the file if it fits in one buffer
+		ByteBuffer mapped = null;
+		PeekableBitInputStream in;
+		if (channel.size() <= Integer.MAX_VALUE) {
+			mapped = channel.map(FileChannel.MapMode.READ_ONLY, 0, channel.size());
+			in = new ByteBufferBitInputStream(mapped);
+		} else
+			in = new BufferedBitInputStream(Channels.newInputStream(channel), 64 * 1024);
+		
+		try (OutputStream out = Files.newOutputStream(outFile)) {
+			if (numThreads <= 1 || mapped == null) {
+				decompressMembers(in, out, info);
+				return;
+			}
+			int numMembers = 0;
+			do {
+				readHeader(in, readUnsignedByte(in), numMembers == 0 ? info : null);
+				numMembers++;
 				
-				// Handle assorted flags
-				if ((flags & 0x01) != 0)
-					System.out.println("Flag: Text");
-				if ((flags & 0x04) != 0) {
-					System.out.println("Flag: Extra");
-					int len = readLittleEndianUint16(in);
-					in.readFully(new byte[len]);  // Skip extra data
+				// Decode in parallel straight from the mapped buffer, then resume reading after the DEFLATE data
+				MemberOutputStream memberOut = new MemberOutputStream(out);
+				mapped.position(((ByteBufferBitInputStream)in).getPosition());
+				try {
+					ParallelDecompressor.decompress(mapped, memberOut, numThreads);
+				} catch (DataFormatException e) {
+					throw new DataFormatException("Invalid or corrupt compressed data: " + e.getMessage());
+				}
+				in = new ByteBufferBitInputStream(mapped);
+				readFooter(in, memberOut.crc, memberOut.size);
+			} while (hasNextMember(in, info));
+			if (numMembers > 1 && info != null)
+				info.println("Members: " + numMembers);
+		}
+	}
+	
+	
+	// Checks every member of the file in order like decompressMembers(), but without any output.
+	private static void verifyMembers(FileChannel channel) throws IOException, DataFormatException {
+		PeekableBitInputStream in;
+		if (channel.size() <= Integer.MAX_VALUE)
+			in = new ByteBufferBitInputStream(channel.map(FileChannel.MapMode.READ_ONLY, 0, channel.size()));
+		else
+			in = new BufferedBitInputStream(Channels.newInputStream(channel), 64 * 1024);
+		decompressMembers(in, null, System.out);
+	}
+	
+	
+	// Decompresses every member from the given stream in order on this thread with the optimized block loops, through
+	// a window that computes the CRC-32 of each batch of output straight from its history and then writes that batch
+	// to the given stream. If the output stream is null, the window keeps only the last 32 KiB and the running CRC-32
+	// and length, so the members are just checked. Header information is printed to the given stream unless it is
+	// null. The output stream is not closed. Package-private for the tests.
+	static void decompressMembers(PeekableBitInputStream in, OutputStream out, PrintStream info) throws IOException, DataFormatException {
+		ChecksumOutputWindow window = out != null ? new ChecksumOutputWindow(out) : new ChecksumOutputWindow();
+		Decompressor decomp = new Decompressor(window);
+		int numMembers = 0;
+		do {
+			readHeader(in, readUnsignedByte(in), numMembers == 0 ? info : null);
+			numMembers++;
+			
+			window.reset();
+			try {
+				decomp.decompressStream(in);
+			} catch (DataFormatException e) {
+				throw new DataFormatException("Invalid or corrupt compressed data: " + e.getMessage());
+			}
+			readFooter(in, window.getCrc(), window.getLength());  // Getting the CRC also writes the rest of the member's output
+		} while (hasNextMember(in, info));
+		if (numMembers > 1 && info != null)
+			info.println("Members: " + numMembers);
+	}
+	
+	
+	// Tests whether the first member of the file is a BGZF block, which records its own compressed size.
+	private static boolean isBgzf(FileChannel channel) throws IOException {
+		ByteBuffer buf = ByteBuffer.allocate((int)Math.min(channel.size(), 1024));
+		while (buf.hasRemaining()) {
+			if (channel.read(buf, buf.position()) == -1)
+				break;
+		}
+		buf.flip();
+		BitInputStream in = new ByteBufferBitInputStream(buf);
+		try {
+			return readHeader(in, in.readByte(), null) != -1;
+		} catch (IOException|DataFormatException e) {
+			return false;  // Let sequential decompression report the problem
+		}
+	}
+	
+	
+	// Decompresses the BGZF file's members on a pool of threads, writing their outputs in order. Each
+	// member is at most 64 KiB in both compressed and decompressed form, and only a bounded number of
+	// them are in flight at a time. The file is mapped in large regions, so it can exceed 2 GiB.
+	private static void decompressBgzf(FileChannel channel, Path outFile, int numThreads)
+			throws IOException, DataFormatException, InterruptedException {
+		ExecutorService executor = Executors.newFixedThreadPool(numThreads);
+		try (OutputStream out = Files.newOutputStream(outFile)) {
+			Queue<Future<byte[]>> pending = new ArrayDeque<>();
+			long fileSize = channel.size();
+			ByteBuffer region = null;
+			long regionStart = 0;
+			int numMembers = 0;
+			for (long pos = 0; pos < fileSize; ) {
+				// Map a new region if the current one might end within this member
+				if (region == null || (pos - regionStart + MAX_BGZF_BLOCK_SIZE > region.limit() && regionStart + region.limit() < fileSize)) {
+					regionStart = pos;
+					region = channel.map(FileChannel.MapMode.READ_ONLY, pos, Math.min(fileSize - pos, BGZF_REGION_SIZE));
 				}
-				if ((flags & 0x08) != 0)
-					System.out.println("File name: " + readNullTerminatedString(in));
-				if ((flags & 0x02) != 0)
-					System.out.printf("Header CRC-16: %04X%n", readLittleEndianUint16(in));
-				if ((flags & 0x10) != 0)
-					System.out.println("Comment: " + readNullTerminatedString(in));
+				int offset = (int)(pos - regionStart);
+				
+				// Parse the header here just to find the member's size
+				ByteBuffer buf = region.duplicate();
+				buf.position(offset);
+				ByteBufferBitInputStream in = new ByteBufferBitInputStream(buf);
+				if (numMembers > 0 && !hasNextMember(in, System.out))
+					break;
+				int blockSize = readHeader(in, in.readByte(), numMembers == 0 ? System.out : null);
+				if (blockSize == -1)
+					throw new DataFormatException("BGZF member lacks block size at offset " + pos);
+				if (blockSize > region.limit() - offset)
+					throw new EOFException();
 				
-				// Decompress
+				buf = region.duplicate();
+				buf.position(offset);
+				buf.limit(offset + blockSize);
+				final ByteBuffer block = buf.slice();
+				pending.add(executor.submit(new Callable<byte[]>() {
+					public byte[] call() throws IOException, DataFormatException {
+						return decompressBgzfBlock(block);
+					}
+				}));
+				while (pending.size() >= numThreads * 4)
+					out.write(getResult(pending.remove()));
+				pos += blockSize;
+				numMembers++;
+			}
+			while (!pending.isEmpty())
+				out.write(getResult(pending.remove()));
+			if (numMembers > 1)
+				System.out.println("Members: " + numMembers);
+		} finally {
+			executor.shutdownNow();
+		}
+	}
+	
+	
+	// Decompresses and checks the single member that exactly fills the given buffer.
+	private static byte[] decompressBgzfBlock(ByteBuffer block) throws IOException, DataFormatException {
+		ByteBufferBitInputStream in = new ByteBufferBitInputStream(block);
+		readHeader(in, in.readByte(), null);
+		ByteArrayOutputStream bout = new ByteArrayOutputStream(MAX_BGZF_BLOCK_SIZE);
+		ChecksumOutputWindow window = new ChecksumOutputWindow(bout);
+		try {
+			new Decompressor(window).decompressStream(in);
+		} catch (DataFormatException e) {
+			throw new DataFormatException("Invalid or corrupt compressed data: " + e.getMessage());
+		}
+		readFooter(in, window.getCrc(), window.getLength());
+		if (in.getPosition() != block.limit())
+			throw new DataFormatException("BGZF block size does not match member length");
+		return bout.toByteArray();
+	}
+	
+	
+	// Waits for the given task and returns its result, rethrowing any exception it threw.
+	private static <T> T getResult(Future<T> future) throws IOException, DataFormatException, InterruptedException {
+		try {
+			return future.get();
+		} catch (ExecutionException e) {
+			Throwable cause = e.getCause();
+			if (cause instanceof IOException)
+				throw (IOException)cause;
+			if (cause instanceof DataFormatException)
+				throw (DataFormatException)cause;
+			if (cause instanceof RuntimeException)
+				throw (RuntimeException)cause;
+			throw (Error)cause;
+		}
+	}
+	
+	
+	/*---- Pipelined decompression ----*/
+	
+	// Decompresses every member of the file in a pipeline of three stages on their own threads, which are connected
+	// by rings in both directions: filled arrays flow downstream, and emptied ones return upstream to be reused.
+	// The reader fills input pieces from the channel; the decoder parses and checks the members, decoding with the
+	// optimized block loops through a window that computes the CRC-32 from its history and then copies the output
+	// into pieces; and the writer writes the output pieces.
+	// When a stage fails it closes all the rings, which stops the other stages, and its exception is rethrown here.
+	// When the decoder finishes before the end of the file (because of trailing data), it closes the input rings to
+	// stop the reader, which could otherwise wait forever for the decoder to return an input piece.
+	private static void decompressPipelined(final FileChannel channel, Path outFile) throws IOException, DataFormatException, InterruptedException {
+		final SpscRing<Piece> emptyInput   = new SpscRing<>(PIPELINE_PIECES);
+		final SpscRing<Piece> filledInput  = new SpscRing<>(PIPELINE_PIECES);
+		final SpscRing<Piece> emptyOutput  = new SpscRing<>(PIPELINE_PIECES);
+		final SpscRing<Piece> filledOutput = new SpscRing<>(PIPELINE_PIECES);
+		for (int i = 0; i < PIPELINE_PIECES; i++) {
+			emptyInput.offer(new Piece(new byte[PIPELINE_PIECE_SIZE]));
+			emptyOutput.offer(new Piece(new byte[PIPELINE_PIECE_SIZE]));
+		}
+		
+		final AtomicBoolean inputUnneeded = new AtomicBoolean(false);
+		
+		final Stage reader = new Stage(emptyInput, filledInput, emptyOutput, filledOutput) {
+			protected void run() throws IOException {
+				// Fill each piece completely unless the file ends, so a short piece is the last one
+				long pos = 0;
 				try {
-					decomp = Decompressor.decompress(new ByteBitInputStream(in));
-				} catch (DataFormatException e) {
-					return "Invalid or corrupt compressed data: " + e.getMessage();
+					while (true) {
+						Piece p = emptyInput.take();
+						ByteBuffer buf = ByteBuffer.wrap(p.data);
+						while (buf.hasRemaining()) {
+							int n = channel.read(buf, pos);
+							if (n == -1)
+								break;
+							pos += n;
+						}
+						p.length = buf.position();
+						filledInput.put(p);
+						if (p.length < p.data.length)
+							break;
+					}
+				} catch (CancellationException e) {
+					if (!inputUnneeded.get())
+						throw e;
+				}
+			}
+		};
+		
+		final Stage decoder = new Stage(emptyInput, filledInput, emptyOutput, filledOutput) {
+			protected void run() throws IOException, DataFormatException {
+				BufferedBitInputStream in = new BufferedBitInputStream(new RingInputStream(emptyInput, filledInput), 64 * 1024);
+				PieceOutputStream out = new PieceOutputStream(emptyOutput, filledOutput);
+				ChecksumOutputWindow window = new ChecksumOutputWindow(out);
+				Decompressor decomp = new Decompressor(window);
+				do {
+					readHeader(in, readUnsignedByte(in), numMembers == 0 ? System.out : null);
+					numMembers++;
+					window.reset();
+					try {
+						decomp.decompressStream(in);
+					} catch (DataFormatException e) {
+						throw new DataFormatException("Invalid or corrupt compressed data: " + e.getMessage());
+					}
+					readFooter(in, window.getCrc(), window.getLength());
+				} while (hasNextMember(in, System.out));
+				out.flush();
+				filledOutput.put(END_OF_OUTPUT);
+				inputUnneeded.set(true);
+				emptyInput.close();
+				filledInput.close();
+			}
+		};
+		
+		try (final FileChannel out = FileChannel.open(outFile, StandardOpenOption.CREATE, StandardOpenOption.TRUNCATE_EXISTING, StandardOpenOption.WRITE)) {
+			Stage writer = new Stage(emptyInput, filledInput, emptyOutput, filledOutput) {
+				protected void run() throws IOException {
+					while (true) {
+						Piece p = filledOutput.take();
+						if (p == END_OF_OUTPUT)
+							break;
+						ByteBuffer buf = ByteBuffer.wrap(p.data, 0, p.length);
+						while (buf.hasRemaining())
+							out.write(buf);
+						emptyOutput.put(p);
+					}
 				}
+			};
+			
+			ExecutorService executor = Executors.newFixedThreadPool(3);
+			try {
+				List<Future<Void>> stages = new ArrayList<>();
+				for (Stage st : new Stage[]{reader, decoder, writer})
+					stages.add(executor.submit(st));
 				
-				// Footer
-				crc  = readLittleEndianInt32(in);
-				size = readLittleEndianInt32(in);
+				// Wait for all the stages, and rethrow the failure that stopped the pipeline (not the resulting cancellations)
+				Exception error = null;
+				for (Future<Void> f : stages) {
+					try {
+						getResult(f);
+					} catch (CancellationException e) {
+						if (error == null)
+							error = e;
+					} catch (IOException|DataFormatException|RuntimeException e) {
+						if (error == null || error instanceof CancellationException)
+							error = e;
+					}
+				}
+				if (error instanceof IOException)
+					throw (IOException)error;
+				if (error instanceof DataFormatException)
+					throw (DataFormatException)error;
+				if (error != null)
+					throw (RuntimeException)error;
+			} finally {
+				executor.shutdownNow();
 			}
+		}
+		if (decoder.numMembers > 1)
+			System.out.println("Members: " + decoder.numMembers);
+	}
+	
+	
+	// A stage of the pipeline, which closes all the rings if it fails so that the other stages stop waiting.
+	private static abstract class Stage implements Callable<Void> {
+		
+		private final SpscRing<?>[] rings;
+		
+		// Used by the decoder stage only.
+		public int numMembers = 0;
+		
+		
+		public Stage(SpscRing<?>... rings) {
+			this.rings = rings;
+		}
+		
+		
+		public Void call() throws IOException, DataFormatException {
+			boolean success = false;
+			try {
+				run();
+				success = true;
+			} finally {
+				if (!success) {
+					for (SpscRing<?> r : rings)
+						r.close();
+				}
+			}
+			return null;
+		}
+		
+		
+		protected abstract void run() throws IOException, DataFormatException;
+		
+	}
+	
+	
+	// A recycled array of data passed between stages, or the marker after the last one (with data null).
+	private static final class Piece {
+		
+		public final byte[] data;
+		public int length;
+		
+		
+		public Piece(byte[] data) {
+			this.data = data;
+		}
+		
+	}
+	
+	
+	// The marker after the last piece of output.
+	private static final Piece END_OF_OUTPUT = new Piece(null);
+	
+	
+	// Copies the data written to it into pieces from the empty ring, passing each one to the filled ring once it is full.
+	private static final class PieceOutputStream extends OutputStream {
+		
+		private final SpscRing<Piece> empty;
+		private final SpscRing<Piece> filled;
+		
+		private Piece current = null;
+		
+		
+		public PieceOutputStream(SpscRing<Piece> empty, SpscRing<Piece> filled) {
+			this.empty = empty;
+			this.filled = filled;
+		}
+		
+		
+		public void write(int b) {
+			write(new byte[]{(byte)b}, 0, 1);
+		}
+		
+		
+		public void write(byte[] b, int off, int len) {
+			if (off < 0 || len < 0 || off > b.length - len)
+				throw new IndexOutOfBoundsException();
+			while (len > 0) {
+				if (current == null) {
+					current = empty.take();
+					current.length = 0;
+				}
+				int n = Math.min(len, current.data.length - current.length);
+				System.arraycopy(b, off, current.data, current.length, n);
+				current.length += n;
+				off += n;
+				len -= n;
+				if (current.length == current.data.length) {
+					filled.put(current);
+					current = null;
+				}
+			}
+		}
+		
+		
+		// Passes on the piece being filled even if it is not full.
+		public void flush() {
+			if (current != null && current.length > 0) {
+				filled.put(current);
+				current = null;
+			}
+		}
+		
+	}
+	
+	
+	// Reads the pieces filled by the reader stage in order, returning each one to be refilled once it is used up.
+	private static final class RingInputStream extends InputStream {
+		
+		private final SpscRing<Piece> empty;
+		private final SpscRing<Piece> filled;
+		
+		private Piece current = null;
+		private int index = 0;
+		private boolean isLast = false;
+		
+		
+		public RingInputStream(SpscRing<Piece> empty, SpscRing<Piece> filled) {
+			this.empty = empty;
+			this.filled = filled;
+		}
+		
+		
+		public int read() {
+			byte[] b = new byte[1];
+			return read(b, 0, 1) == -1 ? -1 : (b[0] & 0xFF);
+		}
+		
+		
+		public int read(byte[] b, int off, int len) {
+			if (off < 0 || len < 0 || off > b.length - len)
+				throw new IndexOutOfBoundsException();
+			if (len == 0)
+				return 0;
+			while (current == null || index == current.length) {
+				if (isLast)
+					return -1;
+				if (current != null)
+					empty.put(current);
+				current = filled.take();
+				index = 0;
+				isLast = current.length < current.data.length;
+			}
+			int n = Math.min(len, current.length - index);
+			System.arraycopy(current.data, index, b, off, n);
+			index += n;
+			return n;
+		}
+		
+	}
+	
+	
+	
+	/*---- Member header and footer ----*/
+	
+	// Reads the header of a member whose first byte has already been read, printing its information
+	// to the given stream unless it is null. Returns the member's total size if it has a BGZF extra subfield,
+	// otherwise -1. Throws DataFormatException with the error message if the header is invalid.
+	private static int readHeader(BitInputStream in, int firstByte, PrintStream info) throws IOException, DataFormatException {
+		int flags;
+		{
+			if (firstByte != 0x1F || readUnsignedByte(in) != 0x8B)
+				throw new DataFormatException("Invalid GZIP magic number");
+			int compMeth = readUnsignedByte(in);
+			if (compMeth != 8)
+				throw new DataFormatException("Unsupported compression method: " + compMeth);
+			flags = readUnsignedByte(in);
 			
-			// Check decompressed data's length and CRC
-			if (size != decomp.length)
-				return String.format("Size mismatch: expected=%d, actual=%d", size, decomp.length);
-			if (crc != getCrc32(decomp))
-				return String.format("CRC-32 mismatch: expected=%08X, actual=%08X", crc, getCrc32(decomp));
+			// Reserved flags
+			if ((flags & 0xE0) != 0)
+				throw new DataFormatException("Reserved flags are set");
 			
-			// Write decompressed data to output file
-			Files.write(outFile, decomp);
+			// Modification time
+			int mtime = readLittleEndianInt32(in);
+			if (info != null) {
+				if (mtime != 0)
+					info.println("Last modified: " + new Date(mtime * 1000L));
+				else
+					info.println("Last modified: N/A");
+			}
 			
-		} catch (IOException e) {
-			return "I/O exception: " + e.getMessage();
+			// Extra flags
+			int extraFlags = readUnsignedByte(in);
+			if (info != null) {
+				switch (extraFlags) {
+					case 2:   info.println("Extra flags: Maximum compression");  break;
+					case 4:   info.println("Extra flags: Fastest compression");  break;
+					default:  info.println("Extra flags: Unknown (" + extraFlags + ")");  break;
+				}
+			}
+			
+			// Operating system
+			String os;
+			switch (readUnsignedByte(in)) {
+				case   0:  os = "FAT";             break;
+				case   1:  os = "Amiga";           break;
+				case   2:  os = "VMS";             break;
+				case   3:  os = "Unix";            break;
+				case   4:  os = "VM/CMS";          break;
+				case   5:  os = "Atari TOS";       break;
+				case   6:  os = "HPFS";            break;
+				case   7:  os = "Macintosh";       break;
+				case   8:  os = "Z-System";        break;
+				case   9:  os = "CP/M";            break;
+				case  10:  os = "TOPS-20";         break;
+				case  11:  os = "NTFS";            break;
+				case  12:  os = "QDOS";            break;
+				case  13:  os = "Acorn RISCOS";    break;
+				case 255:  os = "Unknown";         break;
+				default :  os = "Really unknown";  break;
+			}
+			if (info != null)
+				info.println("Operating system: " + os);
 		}
-		return null;  // Success, no error message
+		
+		// Handle assorted flags
+		int bgzfBlockSize = -1;
+		if ((flags & 0x01) != 0 && info != null)
+			info.println("Flag: Text");
+		if ((flags & 0x04) != 0) {
+			if (info != null)
+				info.println("Flag: Extra");
+			byte[] extra = new byte[readLittleEndianUint16(in)];
+			for (int i = 0; i < extra.length; i++)
+				extra[i] = (byte)readUnsignedByte(in);
+			
+			// Look for the BGZF subfield: ID "BC", length 2, value is the member's total size minus 1
+			for (int i = 0; i + 4 <= extra.length; ) {
+				int subLen = (extra[i + 2] & 0xFF) | (extra[i + 3] & 0xFF) << 8;
+				if (extra[i] == 'B' && extra[i + 1] == 'C' && subLen == 2 && i + 6 <= extra.length)
+					bgzfBlockSize = ((extra[i + 4] & 0xFF) | (extra[i + 5] & 0xFF) << 8) + 1;
+				i += 4 + subLen;
+			}
+		}
+		if ((flags & 0x08) != 0) {
+			String name = readNullTerminatedString(in);
+			if (info != null)
+				info.println("File name: " + name);
+		}
+		if ((flags & 0x02) != 0) {
+			int headerCrc = readLittleEndianUint16(in);
+			if (info != null)
+				info.printf("Header CRC-16: %04X%n", headerCrc);
+		}
+		if ((flags & 0x10) != 0) {
+			String comment = readNullTerminatedString(in);
+			if (info != null)
+				info.println("Comment: " + comment);
+		}
+		return bgzfBlockSize;
+	}
+	
+	
+	// Tests whether another member follows the one just read, i.e. whether the next two bytes are the magic number,
+	// without consuming anything if so. Like gzip, any other trailing data (such as the zero padding that tape and
+	// block devices add) ends the file, with a warning printed to the given stream unless it is null.
+	private static boolean hasNextMember(PeekableBitInputStream in, PrintStream info) throws IOException {
+		if (in.peekBits(16) == 0x8B1F)
+			return true;
+		if (in.readByte() != -1 && info != null)
+			info.println("Warning: trailing garbage ignored");
+		return false;
+	}
+	
+	
+	// Reads a member's footer and checks it against the given CRC and length of the decompressed data.
+	private static void readFooter(BitInputStream in, CRC32 crc, long size) throws IOException, DataFormatException {
+		int expectCrc  = readLittleEndianInt32(in);
+		int expectSize = readLittleEndianInt32(in);
+		checkFooter(expectCrc, expectSize, crc, size);
+	}
+	
+	
+	// Checks the given footer values against the given CRC and length of the decompressed data.
+	private static void checkFooter(int expectCrc, int expectSize, CRC32 crc, long size) throws DataFormatException {
+		// Check decompressed data's length (modulo 2^32) and CRC
+		if (expectSize != (int)size)
+			throw new DataFormatException(String.format("Size mismatch: expected=%d, actual=%d", expectSize & 0xFFFFFFFFL, size & 0xFFFFFFFFL));
+		int actualCrc = (int)crc.getValue();
+		if (expectCrc != actualCrc)
+			throw new DataFormatException(String.format("CRC-32 mismatch: expected=%08X, actual=%08X", expectCrc, actualCrc));
 	}
 	
 	
 	/*---- Helper methods ----*/
 	
-	private static String readNullTerminatedString(DataInput in) throws IOException {
+	private static String readNullTerminatedString(BitInputStream in) throws IOException {
 		ByteArrayOutputStream bout = new ByteArrayOutputStream();
 		while (true) {
-			byte b = in.readByte();
+			int b = readUnsignedByte(in);
 			if (b == 0)
 				break;
 			bout.write(b);
@@ -165,20 +870,66 @@ public final class GzipDecompress {
 	}
 	
 	
-	private static int getCrc32(byte[] data) {
-		CRC32 crc = new CRC32();
-		crc.update(data);
-		return (int)crc.getValue();
+	private static int readUnsignedByte(BitInputStream in) throws IOException {
+		int result = in.readByte();
+		if (result == -1)
+			throw new EOFException();
+		return result;
 	}
 	
 	
-	private static int readLittleEndianUint16(DataInput in) throws IOException {
-		return Integer.reverseBytes(in.readUnsignedShort()) >>> 16;
+	private static int readLittleEndianUint16(BitInputStream in) throws IOException {
+		int temp = readUnsignedByte(in);
+		return temp | readUnsignedByte(in) << 8;
 	}
 	
 	
-	private static int readLittleEndianInt32(DataInput in) throws IOException {
-		return Integer.reverseBytes(in.readInt());
+	private static int readLittleEndianInt32(BitInputStream in) throws IOException {
+		int temp = readLittleEndianUint16(in);
+		return temp | readLittleEndianUint16(in) << 16;
+	}
+	
+	
+	// Passes data through to the output file, keeping the CRC-32 and length of the current member's data.
+	private static final class MemberOutputStream extends FilterOutputStream {
+		
+		public final CRC32 crc = new CRC32();
+		public long size = 0;
+		
+		
+		public MemberOutputStream(OutputStream out) {
+			super(out);
+		}
+		
+		
+		public void write(int b) throws IOException {
+			out.write(b);
+			crc.update(b);
+			size++;
+		}
+		
+		
+		public void write(byte[] b, int off, int len) throws IOException {
+			out.write(b, off, len);
+			crc.update(b, off, len);
+			size += len;
+		}
+		
 	}
 	
+	
+	private static final String USAGE = "Usage: java GzipDecompress [-j Threads | -p] InputFile.gz OutputFile"
+		+ System.lineSeparator() + "   or: java GzipDecompress -t InputFile.gz"
+		+ System.lineSeparator() + "   or: java GzipDecompress -b [-q] [-j Threads] (InputDir OutputDir | InputFile.gz OutputFile ...)";
+	
+	// A BGZF member's size is stored in 16 bits, less one.
+	private static final int MAX_BGZF_BLOCK_SIZE = 1 << 16;
+	
+	// Size of each memory-mapped view of a BGZF file, which holds many whole members.
+	private static final long BGZF_REGION_SIZE = 1 << 30;
+	
+	// Number and size of the recycled arrays in each direction between pipeline stages.
+	private static final int PIPELINE_PIECES = 16;
+	private static final int PIPELINE_PIECE_SIZE = 256 * 1024;
+	
 }
@@ -0,0 +1,123 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.util.Arrays;
+
+
+/**
+ * A small cache of recently built canonical codes keyed by their code lengths, plus scratch
+ * arrays for reading dynamic Huffman block headers. Encoders often repeat the same code lengths
+ * in consecutive blocks and streams, and a hit avoids rebuilding the decode tables. The cache is
+ * direct-mapped: each set of code lengths has one slot, chosen by its hash, and a miss replaces
+ * the slot's entry. Mutable and not thread-safe (but the returned codes are immutable).
+ */
+final class HuffmanTableCache {
+	
+	/*---- Fields ----*/
+	
+	// Scratch space for the code length code's lengths (in symbol order).
+	final int[] codeLenCodeLen = new int[19];
+	
+	// Scratch space for the literal/length and distance code lengths (at most 288 + 32).
+	final int[] codeLens = new int[320];
+	
+	// The pair of codes returned by Decompressor.decodeHuffmanCodes().
+	final CanonicalCode[] decodedCodes = new CanonicalCode[2];
+	
+	// Cache slots; an empty slot has a null key.
+	private int[] hashes = new int[NUM_SLOTS];
+	private int[][] keys = new int[NUM_SLOTS][];
+	private CanonicalCode[] codes = new CanonicalCode[NUM_SLOTS];
+	
+	// Fused table slots, keyed by the identities of the codes (which are themselves cached).
+	private CanonicalCode[] blockLitLenCodes = new CanonicalCode[NUM_BLOCK_SLOTS];
+	private CanonicalCode[] blockDistCodes = new CanonicalCode[NUM_BLOCK_SLOTS];
+	private BlockDecodeTable[] blockTables = new BlockDecodeTable[NUM_BLOCK_SLOTS];
+	
+	
+	
+	/*---- Methods ----*/
+	
+	/**
+	 * Returns a canonical code for the specified range of code lengths, from
+	 * this cache if possible, otherwise by constructing it and caching it.
+	 * @param codeLengths the array containing the code lengths (not {@code null})
+	 * @param off the index of the first code length
+	 * @param len the number of code lengths
+	 * @return a canonical code with the given code lengths (not {@code null})
+	 * @throws IllegalArgumentException if the code lengths are invalid for {@link CanonicalCode}
+	 */
+	public CanonicalCode get(int[] codeLengths, int off, int len) {
+		int hash = len;
+		for (int i = 0; i < len; i++)
+			hash = hash * 31 + codeLengths[off + i];
+		int slot = (hash ^ (hash >>> 16)) & (NUM_SLOTS - 1);
+		
+		int[] key = keys[slot];
+		if (key != null && hashes[slot] == hash && key.length == len) {
+			boolean equal = true;
+			for (int i = 0; i < len && equal; i++)
+				equal = key[i] == codeLengths[off + i];
+			if (equal)
+				return codes[slot];
+		}
+		
+		key = Arrays.copyOfRange(codeLengths, off, off + len);
+		CanonicalCode result = new CanonicalCode(key);  // Can throw, in which case nothing is cached
+		hashes[slot] = hash;
+		keys[slot] = key;
+		codes[slot] = result;
+		return result;
+	}
+	
+	
+	/**
+	 * Returns the fused decoding tables for the specified pair of codes, from this cache if
+	 * possible, otherwise by constructing them and caching them. Codes returned by {@link #get}
+	 * for repeated code lengths are the same objects, so the pair is matched by identity.
+	 * @param litLenCode the literal/length code (not {@code null})
+	 * @param distCode the distance code (not {@code null})
+	 * @return the fused tables of the codes (not {@code null})
+	 * @throws IllegalArgumentException if the alphabets are invalid for {@link BlockDecodeTable}
+	 */
+	public BlockDecodeTable getBlockTable(CanonicalCode litLenCode, CanonicalCode distCode) {
+		int hash = System.identityHashCode(litLenCode) * 31 + System.identityHashCode(distCode);
+		int slot = (hash ^ (hash >>> 16)) & (NUM_BLOCK_SLOTS - 1);
+		if (blockLitLenCodes[slot] == litLenCode && blockDistCodes[slot] == distCode)
+			return blockTables[slot];
+		
+		BlockDecodeTable result = new BlockDecodeTable(litLenCode, distCode);
+		blockLitLenCodes[slot] = litLenCode;
+		blockDistCodes[slot] = distCode;
+		blockTables[slot] = result;
+		return result;
+	}
+	
+	
+	/**
+	 * Removes all entries from this cache.
+	 */
+	public void clear() {
+		Arrays.fill(keys, null);
+		Arrays.fill(codes, null);
+		Arrays.fill(blockLitLenCodes, null);
+		Arrays.fill(blockDistCodes, null);
+		Arrays.fill(blockTables, null);
+	}
+	
+	
+	
+	/*---- Constants ----*/
+	
+	// Must be a power of 2. Each block uses up to three codes, so this holds the codes of several distinct blocks.
+	private static final int NUM_SLOTS = 16;
+	
+	// Must be a power of 2. Each block uses one pair of codes.
+	private static final int NUM_BLOCK_SLOTS = 8;
+	
+}
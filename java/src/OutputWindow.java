@@ -0,0 +1,57 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.io.IOException;
+
+
+/**
+ * The destination of decompressed bytes, which also remembers enough of the recent output
+ * to resolve back-references. Bytes before the start of the output read as zeros.
+ */
+interface OutputWindow {
+	
+	/**
+	 * Appends the specified byte to the output.
+	 * @param b the byte value to append
+	 * @throws IOException if an I/O exception occurs
+	 */
+	public void append(int b) throws IOException;
+	
+	
+	/**
+	 * Appends the specified range of bytes to the output.
+	 * @param b the array of bytes to append (not {@code null})
+	 * @param off the index of the first byte to append
+	 * @param len the number of bytes to append
+	 * @throws IOException if an I/O exception occurs
+	 */
+	public void append(byte[] b, int off, int len) throws IOException;
+	
+	
+	/**
+	 * Appends up to {@code len} whole bytes read in bulk from the specified stream, after discarding the
+	 * remainder of its current byte. Returns the number of bytes appended, which is less than {@code len}
+	 * only if the input stream ran out of bytes.
+	 * @param in the bit input stream to read from (not {@code null})
+	 * @param len the maximum number of bytes to append, which must be at least 0
+	 * @return the number of bytes appended
+	 * @throws IOException if an I/O exception occurs
+	 */
+	public int appendFrom(PeekableBitInputStream in, int len) throws IOException;
+	
+	
+	/**
+	 * Appends {@code len} bytes copied from {@code dist} bytes before the end of the output.
+	 * If the length exceeds the distance, then the bytes appended earlier in this copy are repeated.
+	 * @param dist the distance to go back, in the range [1, 32768]
+	 * @param len the length to copy, which must be at least 0
+	 * @throws IOException if an I/O exception occurs
+	 */
+	public void copy(int dist, int len) throws IOException;
+	
+}
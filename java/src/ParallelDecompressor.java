@@ -0,0 +1,363 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.io.BufferedOutputStream;
+import java.io.EOFException;
+import java.io.IOException;
+import java.io.InterruptedIOException;
+import java.io.OutputStream;
+import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
+import java.util.Arrays;
+import java.util.HashMap;
+import java.util.Map;
+import java.util.Objects;
+import java.util.concurrent.Callable;
+import java.util.concurrent.CancellationException;
+import java.util.concurrent.ExecutionException;
+import java.util.concurrent.ExecutorService;
+import java.util.concurrent.Executors;
+import java.util.concurrent.Future;
+import java.util.zip.DataFormatException;
+
+
+/**
+ * Decompresses a single raw DEFLATE stream on several threads by speculative decoding.
+ * <p>The input is cut into chunks of equal size. For each chunk after the first, a worker thread
+ * scans bit by bit from the chunk's start for a position where a dynamic Huffman block header
+ * builds valid codes and the blocks that follow decode without error. It decodes from there to the
+ * first block boundary at or after the chunk's end, with the unknown 32 KiB of preceding output
+ * represented by markers. Meanwhile the chunks are resolved in order: if a chunk's speculative start
+ * is exactly where the previous chunk's decoding ended, its markers are replaced with bytes from the
+ * previous output; otherwise (no candidate found, or a false positive) it is decoded again from the
+ * true position, straight to the output stream. Thus the output is always identical to sequential
+ * decompression.</p>
+ * <p>Memory use is bounded regardless of the compression ratio: at most one speculation per thread is
+ * outstanding, and a speculation whose output grows beyond a limit (a few times the chunk size, stored
+ * as 2 bytes per output byte) is abandoned, so that its chunk is decoded in order instead.</p>
+ */
+public final class ParallelDecompressor {
+	
+	/*---- Public functions ----*/
+	
+	/**
+	 * Reads from the specified buffer in place, decompresses the data using the specified number of threads,
+	 * and writes to the specified output stream. The data starts at the buffer's position, and on success
+	 * the position is advanced to just after the end of the DEFLATE data.
+	 * @param in the byte buffer to read from (not {@code null})
+	 * @param out the byte output stream to write to (not {@code null})
+	 * @param numThreads the number of worker threads, which must be positive
+	 * @throws NullPointerException if the buffer or output stream is {@code null}
+	 * @throws IllegalArgumentException if the number of threads is not positive
+	 * @throws EOFException if the buffer ends before the DEFLATE data does
+	 * @throws DataFormatException if the DEFLATE data is malformed
+	 */
+	public static void decompress(ByteBuffer in, OutputStream out, int numThreads) throws IOException, DataFormatException {
+		decompress(in, out, numThreads, DEFAULT_CHUNK_SIZE);
+	}
+	
+	
+	// Same as above, but with the given chunk size in bytes (exposed for testing).
+	static void decompress(ByteBuffer in, OutputStream out, int numThreads, int chunkSize) throws IOException, DataFormatException {
+		Objects.requireNonNull(in);
+		Objects.requireNonNull(out);
+		if (numThreads < 1 || chunkSize < 1)
+			throw new IllegalArgumentException();
+		
+		final ByteBuffer buf = in.slice();  // Bit offsets are counted from the start of this view
+		final long totalBits = buf.limit() * 8L;
+		final int numChunks = Math.max((buf.limit() - 1) / chunkSize + 1, 1);
+		final long chunkBits = chunkSize * 8L;
+		final int maxSpeculativeOutput = (int)Math.min(Math.max(chunkSize * (long)MAX_SPECULATIVE_EXPANSION, MIN_SPECULATIVE_OUTPUT), MAX_ARRAY_LENGTH);
+		Map<Integer,Future<Chunk>> speculations = new HashMap<>();
+		int nextToSubmit = 1;
+		HuffmanTableCache cache = new HuffmanTableCache();
+		ExecutorService executor = Executors.newFixedThreadPool(numThreads);
+		try {
+			OutputStream bufOut = new BufferedOutputStream(out, 64 * 1024);  // The in-order decoder appends byte by byte
+			StreamOutputWindow output = new StreamOutputWindow(bufOut);
+			long pos = 0;  // Bit offset of the next block
+			int lastChunkIndex = 0;
+			while (true) {
+				// Keep a bounded number of speculative decodes running ahead of this chunk
+				int index = (int)Math.min(pos / chunkBits, numChunks - 1);
+				for (; nextToSubmit < numChunks && nextToSubmit <= index + numThreads; nextToSubmit++) {
+					final long startBit = nextToSubmit * chunkBits;
+					final long stopBit = Math.min(startBit + chunkBits, totalBits);
+					speculations.put(nextToSubmit, executor.submit(new Callable<Chunk>() {
+						public Chunk call() {
+							return speculate(buf, startBit, stopBit, maxSpeculativeOutput);
+						}
+					}));
+				}
+				
+				// Drop the chunks that the previous one overran, then use this chunk's result if it starts in the right place
+				for (; lastChunkIndex < index; lastChunkIndex++) {
+					Future<Chunk> f = speculations.remove(lastChunkIndex);
+					if (f != null)
+						f.cancel(true);
+				}
+				Chunk chunk = null;
+				Future<Chunk> f = speculations.remove(index);
+				if (f != null) {
+					chunk = getResult(f);
+					if (chunk != null && chunk.startBit != pos)
+						chunk = null;
+				}
+				boolean isFinal;
+				if (chunk != null) {
+					chunk.resolveTo(output.getHistory(), output);
+					isFinal = chunk.isFinal;
+					pos = chunk.endBit;
+				} else {
+					// Decode this chunk's range in order, straight to the output
+					ByteBufferBitInputStream bitIn = ByteBufferBitInputStream.openAtBitOffset(buf, pos);
+					isFinal = decodeBlocks(bitIn, Math.min((index + 1) * chunkBits, totalBits), cache, output);
+					pos = bitIn.getBitOffset();
+				}
+				if (isFinal) {
+					bufOut.flush();
+					in.position(in.position() + (int)((pos + 7) >>> 3));
+					break;
+				}
+			}
+		} catch (InterruptedException e) {
+			Thread.currentThread().interrupt();
+			throw new IOException("Interrupted", e);
+		} finally {
+			executor.shutdownNow();
+		}
+	}
+	
+	
+	
+	/*---- Private helper functions ----*/
+	
+	// Scans from startBit to stopBit for a plausible dynamic block header and returns the decoding of blocks
+	// from the first position that works, or null if no position in the range works, if the output would
+	// exceed the given number of bytes, or if this thread is interrupted.
+	private static Chunk speculate(ByteBuffer buf, long startBit, long stopBit, int maxOutput) {
+		HuffmanTableCache cache = new HuffmanTableCache();
+		// One stream for the whole scan, repositioned at each candidate bit without allocating
+		ByteBuffer view = buf.duplicate().order(ByteOrder.LITTLE_ENDIAN);
+		ByteBufferBitInputStream in = new ByteBufferBitInputStream(view);
+		for (long bit = startBit; bit < stopBit; bit++) {
+			if (Thread.currentThread().isInterrupted())
+				return null;
+			try {
+				// Cheap filter: btype = 2, hlit + 257 <= 286, hdist + 1 <= 30
+				in.reset(view, (int)(bit >>> 3), view.limit());
+				in.consumeBits((int)bit & 7);
+				int header = in.peekBits(13);
+				if (((header >>> 1) & 3) != 2 || ((header >>> 3) & 0x1F) > 29 || ((header >>> 8) & 0x1F) > 29)
+					continue;
+				Chunk chunk = new Chunk(bit, maxOutput);
+				chunk.isFinal = decodeBlocks(in, stopBit, cache, chunk);
+				chunk.endBit = in.getBitOffset();
+				return chunk;
+			} catch (ChunkFullException e) {
+				return null;  // Leave this chunk to the in-order decoder, which streams its output
+			} catch (IOException|DataFormatException e) {}  // Not a block start, or not a useful one
+		}
+		return null;
+	}
+	
+	
+	// Decodes blocks from the given stream into the given window until one ends at or after stopBit or is the final
+	// block, and returns whether that block is the final one. Throws an exception if the data is invalid or truncated,
+	// or InterruptedIOException if this thread is interrupted (checked before each block, so cancellation is prompt).
+	private static boolean decodeBlocks(ByteBufferBitInputStream in, long stopBit, HuffmanTableCache cache, OutputWindow out)
+			throws IOException, DataFormatException {
+		boolean isFinal;
+		do {
+			if (Thread.currentThread().isInterrupted())
+				throw new InterruptedIOException();
+			isFinal = in.readNoEof() == 1;  // bfinal
+			int type = Decompressor.readInt(2, in);  // btype
+			if (type == 0)
+				decodeUncompressedBlock(in, out);
+			else if (type == 1)
+				decodeHuffmanBlock(in, Decompressor.FIXED_LITERAL_LENGTH_CODE, Decompressor.FIXED_DISTANCE_CODE, out);
+			else if (type == 2) {
+				CanonicalCode[] litLenAndDist = Decompressor.decodeHuffmanCodes(in, cache);
+				decodeHuffmanBlock(in, litLenAndDist[0], litLenAndDist[1], out);
+			} else if (type == 3)
+				throw new DataFormatException("Reserved block type");
+			else
+				throw new AssertionError("Impossible value");
+		} while (!isFinal && in.getBitOffset() < stopBit);
+		return isFinal;
+	}
+	
+	
+	private static void decodeUncompressedBlock(ByteBufferBitInputStream in, OutputWindow out) throws IOException, DataFormatException {
+		// Discard bits to align to byte boundary
+		while (in.getBitPosition() != 0)
+			in.readNoEof();
+		
+		int len  = Decompressor.readInt(16, in);
+		int nlen = Decompressor.readInt(16, in);
+		if ((len ^ 0xFFFF) != nlen)
+			throw new DataFormatException("Invalid length in uncompressed block");
+		if (out.appendFrom(in, len) < len)
+			throw new EOFException();
+	}
+	
+	
+	private static void decodeHuffmanBlock(ByteBufferBitInputStream in, CanonicalCode litLenCode, CanonicalCode distCode, OutputWindow out)
+			throws IOException, DataFormatException {
+		while (true) {
+			int sym = litLenCode.decodeNextSymbol(in);
+			if (sym == 256)  // End of block
+				break;
+			
+			if (sym < 256)  // Literal byte
+				out.append(sym);
+			else {  // Length and distance for copying
+				int run = Decompressor.decodeRunLength(sym, in);
+				if (distCode == null)
+					throw new DataFormatException("Length symbol encountered with empty distance code");
+				int distSym = distCode.decodeNextSymbol(in);
+				int dist = Decompressor.decodeDistance(distSym, in);
+				out.copy(dist, run);
+			}
+		}
+	}
+	
+	
+	// Waits for the given speculation and returns its result, or null if it failed. The failure is not rethrown,
+	// because the in-order decoder then decodes the same range and reports any real problem itself.
+	private static Chunk getResult(Future<Chunk> future) throws InterruptedException {
+		try {
+			return future.get();
+		} catch (ExecutionException|CancellationException e) {
+			return null;
+		}
+	}
+	
+	
+	
+	/*---- Helper classes ----*/
+	
+	/*
+	 * The output of decoding a run of blocks without knowing the output that precedes them. Each element
+	 * of data is either a byte value in [0, 256), or 256 + i for the byte at index i of the 32 KiB
+	 * window of output just before the run (so distances that reach before the run become markers).
+	 */
+	private static final class Chunk implements OutputWindow {
+		
+		public final long startBit;
+		public long endBit;
+		public boolean isFinal;
+		
+		private char[] data = new char[1024];
+		private int length = 0;
+		private final int maxLength;
+		
+		
+		public Chunk(long startBit, int maxLength) {
+			this.startBit = startBit;
+			this.maxLength = maxLength;
+		}
+		
+		
+		public void append(int b) throws ChunkFullException {
+			if (length == data.length)
+				grow(1);
+			data[length] = (char)b;
+			length++;
+		}
+		
+		
+		public void append(byte[] b, int off, int len) throws ChunkFullException {
+			if (data.length - length < len)
+				grow(len);
+			for (int i = 0; i < len; i++)
+				data[length + i] = (char)(b[off + i] & 0xFF);
+			length += len;
+		}
+		
+		
+		public int appendFrom(PeekableBitInputStream in, int len) throws IOException {
+			if (data.length - length < len)
+				grow(len);
+			int count = 0;
+			for (; count < len; count++) {
+				int b = in.readByte();
+				if (b == -1)
+					break;
+				data[length + count] = (char)b;
+			}
+			length += count;
+			return count;
+		}
+		
+		
+		public void copy(int dist, int len) throws ChunkFullException {
+			if (data.length - length < len)
+				grow(len);
+			int readIndex = length - dist;
+			if (readIndex >= 0 && dist >= len)
+				System.arraycopy(data, readIndex, data, length, len);
+			else {
+				// Byte by byte, since the source can overlap with the destination or start before the run
+				for (int i = 0; i < len; i++, readIndex++)
+					data[length + i] = readIndex < 0 ? (char)(256 + WINDOW_SIZE + readIndex) : data[readIndex];
+			}
+			length += len;
+		}
+		
+		
+		// Appends the bytes of this run to the given output a piece at a time, taking
+		// marked bytes from the given window (the 32 KiB of output before the run).
+		public void resolveTo(byte[] window, OutputWindow out) throws IOException {
+			byte[] buf = new byte[Math.min(length, 64 * 1024)];
+			for (int i = 0; i < length; ) {
+				int n = Math.min(buf.length, length - i);
+				for (int j = 0; j < n; j++, i++) {
+					int x = data[i];
+					buf[j] = x < 256 ? (byte)x : window[x - 256];
+				}
+				out.append(buf, 0, n);
+			}
+		}
+		
+		
+		private void grow(int n) throws ChunkFullException {
+			if ((long)length + n > maxLength)
+				throw new ChunkFullException();
+			data = Arrays.copyOf(data, (int)Math.min(Math.max((long)length + n, data.length * 2L), maxLength));
+		}
+		
+	}
+	
+	
+	// Thrown when a speculative chunk's output would exceed its limit.
+	private static final class ChunkFullException extends IOException {
+		
+		private static final long serialVersionUID = 1L;
+		
+	}
+	
+	
+	
+	/*---- Constants ----*/
+	
+	// Compressed bytes per chunk, large enough that speculative decoding costs little in comparison.
+	private static final int DEFAULT_CHUNK_SIZE = 4 << 20;
+	
+	private static final int WINDOW_SIZE = 32 * 1024;
+	
+	// A speculation may hold this many times its chunk size in output, but at least the minimum
+	// (so small chunks still work). Beyond that, decoding in order costs less than holding the output.
+	private static final int MAX_SPECULATIVE_EXPANSION = 4;
+	private static final int MIN_SPECULATIVE_OUTPUT = 1 << 20;
+	
+	private static final int MAX_ARRAY_LENGTH = Integer.MAX_VALUE - 8;
+	
+}
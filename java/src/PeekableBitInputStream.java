@@ -0,0 +1,69 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.io.EOFException;
+import java.io.IOException;
+
+
+/**
+ * A stream of bits that can also look ahead at upcoming bits without consuming them,
+ * and read several bits at once. Multi-bit values are packed in little endian, so
+ * the next bit of the stream is the least significant bit of the returned value.
+ */
+public interface PeekableBitInputStream extends BitInputStream {
+	
+	/**
+	 * Returns the next {@code numBits} bits of this stream without consuming them. If fewer bits
+	 * remain before the end of stream, then the missing high bits of the result are zero.
+	 * @param numBits the number of bits to look at, in the range [0, 32]
+	 * @return the upcoming bits packed in little endian
+	 * @throws IllegalArgumentException if the number of bits is out of range
+	 * @throws IOException if an I/O exception occurred
+	 */
+	public int peekBits(int numBits) throws IOException;
+	
+	
+	/**
+	 * Skips the next {@code numBits} bits of this stream, which are usually bits that were just peeked.
+	 * @param numBits the number of bits to skip, in the range [0, 32]
+	 * @throws IllegalArgumentException if the number of bits is out of range
+	 * @throws IOException if an I/O exception occurred
+	 * @throws EOFException if fewer bits remain before the end of stream
+	 * (in which case no bits have been consumed)
+	 */
+	public void consumeBits(int numBits) throws IOException;
+	
+	
+	/**
+	 * Reads the next {@code numBits} bits of this stream as a single integer.
+	 * This is equivalent to {@code peekBits(numBits)} followed by {@code consumeBits(numBits)}.
+	 * @param numBits the number of bits to read, in the range [0, 32]
+	 * @return the bits read, packed in little endian
+	 * @throws IllegalArgumentException if the number of bits is out of range
+	 * @throws IOException if an I/O exception occurred
+	 * @throws EOFException if fewer bits remain before the end of stream
+	 */
+	public int readBits(int numBits) throws IOException;
+	
+	
+	/**
+	 * Discards the remainder of the current byte (if any) and reads up to {@code len} whole bytes into
+	 * the specified array range in bulk. Returns the number of bytes read, which is less than {@code len}
+	 * only if the end of stream is reached (or if the stream's available bytes run out, for a stream
+	 * whose bytes are supplied incrementally).
+	 * @param b the array to write to (not {@code null})
+	 * @param off the index in the array to write the first byte to
+	 * @param len the maximum number of bytes to read
+	 * @return the number of bytes read, between 0 and {@code len}
+	 * @throws NullPointerException if the array is {@code null}
+	 * @throws IndexOutOfBoundsException if the array range is out of bounds
+	 * @throws IOException if an I/O exception occurred
+	 */
+	public int readBytes(byte[] b, int off, int len) throws IOException;
+	
+}
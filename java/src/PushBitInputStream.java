@@ -0,0 +1,231 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.io.EOFException;
+import java.util.Arrays;
+import java.util.Objects;
+
+
+/**
+ * A stream of bits over bytes that are pushed into it piece by piece. Running out of bytes is
+ * reported like the end of stream, and a marked position can be returned to, so that a reader can
+ * undo a partly read item and retry it once more bytes have arrived. Mutable and not thread-safe.
+ */
+final class PushBitInputStream implements PeekableBitInputStream {
+	
+	/*---- Fields ----*/
+	
+	// Bytes that have been pushed; the ones in [markIndex, length) are still kept.
+	private byte[] data;
+	private int length;
+	
+	// Position of the next bit to read, as a byte index and a bit index in the range [0, 8).
+	private int index;
+	private int bitIndex;
+	
+	// Position saved by mark(), which is at or before the current position.
+	private int markIndex;
+	private int markBitIndex;
+	
+	// Thrown on every underflow, which is routine for this stream, so that it costs no allocation.
+	private final EOFException underflow = new EOFException("More input needed");
+	
+	
+	
+	/*---- Constructor ----*/
+	
+	/**
+	 * Constructs a bit input stream with no bytes available yet.
+	 */
+	public PushBitInputStream() {
+		data = new byte[1024];
+		length = 0;
+		index = 0;
+		bitIndex = 0;
+		markIndex = 0;
+		markBitIndex = 0;
+	}
+	
+	
+	
+	/*---- Methods ----*/
+	
+	/**
+	 * Appends the specified bytes to the end of this stream. Bytes before the marked position
+	 * are discarded to make room, so the stream can only be reset to the current mark.
+	 * @param b the array to read from (not {@code null})
+	 * @param off the index of the first byte to append
+	 * @param len the number of bytes to append
+	 * @throws NullPointerException if the array is {@code null}
+	 * @throws IndexOutOfBoundsException if the array range is out of bounds
+	 */
+	public void feed(byte[] b, int off, int len) {
+		Objects.requireNonNull(b);
+		if (off < 0 || len < 0 || off > b.length - len)
+			throw new IndexOutOfBoundsException();
+		
+		// Shift the kept bytes to the front, then grow the array if still needed
+		if (markIndex > 0) {
+			System.arraycopy(data, markIndex, data, 0, length - markIndex);
+			length -= markIndex;
+			index -= markIndex;
+			markIndex = 0;
+		}
+		if (data.length - length < len) {
+			long newCapacity = Math.max((long)length + len, data.length * 2L);
+			if (newCapacity > Integer.MAX_VALUE - 8) {
+				if ((long)length + len > Integer.MAX_VALUE - 8)
+					throw new OutOfMemoryError("Input exceeds maximum array size");
+				newCapacity = Integer.MAX_VALUE - 8;
+			}
+			data = Arrays.copyOf(data, (int)newCapacity);
+		}
+		System.arraycopy(b, off, data, length, len);
+		length += len;
+	}
+	
+	
+	/**
+	 * Remembers the current position, for a later call to {@link #reset()}.
+	 */
+	public void mark() {
+		markIndex = index;
+		markBitIndex = bitIndex;
+	}
+	
+	
+	/**
+	 * Moves back to the position of the last call to {@link #mark()},
+	 * so that the bits read since then will be read again.
+	 */
+	public void reset() {
+		index = markIndex;
+		bitIndex = markBitIndex;
+	}
+	
+	
+	/**
+	 * Returns the number of whole bytes after the current position, not counting the partly read current byte.
+	 * @return the number of unread whole bytes
+	 */
+	public int getRemaining() {
+		return length - index - (bitIndex > 0 ? 1 : 0);
+	}
+	
+	
+	public int getBitPosition() {
+		return bitIndex;
+	}
+	
+	
+	public int readByte() {
+		if (bitIndex != 0) {  // Discard the remainder of the current byte
+			bitIndex = 0;
+			index++;
+		}
+		if (index == length)
+			return -1;
+		int result = data[index] & 0xFF;
+		index++;
+		return result;
+	}
+	
+	
+	public int read() {
+		if (index == length)
+			return -1;
+		int result = (data[index] >>> bitIndex) & 1;
+		bitIndex++;
+		if (bitIndex == 8) {
+			bitIndex = 0;
+			index++;
+		}
+		return result;
+	}
+	
+	
+	public int readNoEof() throws EOFException {
+		int result = read();
+		if (result == -1)
+			throw underflow;
+		return result;
+	}
+	
+	
+	public int peekBits(int numBits) {
+		if (numBits < 0 || numBits > 32)
+			throw new IllegalArgumentException();
+		// Gather up to 5 bytes, which cover any 32 bits starting within the current byte
+		long bits = 0;
+		int n = Math.min(length - index, 5);
+		for (int i = 0; i < n; i++)
+			bits |= (data[index + i] & 0xFFL) << (i * 8);
+		return (int)((bits >>> bitIndex) & ((1L << numBits) - 1));
+	}
+	
+	
+	public void consumeBits(int numBits) throws EOFException {
+		if (numBits < 0 || numBits > 32)
+			throw new IllegalArgumentException();
+		long end = (long)index * 8 + bitIndex + numBits;
+		if (end > (long)length * 8)
+			throw underflow;
+		index = (int)(end >>> 3);
+		bitIndex = (int)end & 7;
+	}
+	
+	
+	public int readBits(int numBits) throws EOFException {
+		int result = peekBits(numBits);
+		consumeBits(numBits);
+		return result;
+	}
+	
+	
+	public int readBytes(byte[] b, int off, int len) {
+		if (off < 0 || len < 0 || off > b.length - len)
+			throw new IndexOutOfBoundsException();
+		if (bitIndex != 0) {  // Discard the remainder of the current byte
+			bitIndex = 0;
+			index++;
+		}
+		int n = Math.min(len, length - index);
+		System.arraycopy(data, index, b, off, n);
+		index += n;
+		return n;
+	}
+	
+	
+	/**
+	 * Discards all bytes and marks, keeping the allocated storage for reuse.
+	 */
+	public void clear() {
+		length = 0;
+		index = 0;
+		bitIndex = 0;
+		markIndex = 0;
+		markBitIndex = 0;
+	}
+	
+	
+	// Returns the preallocated exception that this stream throws when it runs out of bytes.
+	EOFException underflow() {
+		return underflow;
+	}
+	
+	
+	public void close() {
+		data = new byte[0];
+		length = 0;
+		index = 0;
+		bitIndex = 0;
+		markIndex = 0;
+		markBitIndex = 0;
+	}
+	
+}
@@ -0,0 +1,380 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.io.EOFException;
+import java.io.IOException;
+import java.util.Objects;
+import java.util.zip.DataFormatException;
+
+
+/**
+ * Decompresses raw DEFLATE data (without zlib or gzip container) into caller-supplied arrays, a piece
+ * at a time. Each call to {@link #decompress(byte[], int, int)} fills the given array range as far as
+ * possible and then returns, and the next call resumes where the previous one stopped (even in the
+ * middle of a block or a copy). Only the last 32 KiB of output is retained. Mutable and not thread-safe.
+ * <p>The input is either pulled from a bit input stream, which may block, or pushed in with
+ * {@link #feed(byte[], int, int)}. In the latter case decompression never blocks: when the input
+ * runs out (even in the middle of a block header or a symbol), {@code decompress()} undoes the
+ * partly read item and returns early, and {@link #needsInput()} becomes true until more is fed.</p>
+ */
+public final class ResumableDecompressor {
+	
+	/*---- Fields ----*/
+	
+	private BitInputStream input;
+	
+	// The same object as input when the input is pushed by the caller, otherwise null.
+	private PushBitInputStream pushInput;
+	
+	// Whether the last call to decompress() ran out of pushed input.
+	private boolean needsInput;
+	
+	// Whether decompress() returns at the end of every block, not just when the array range is full.
+	private boolean stopAtBlockEnds;
+	
+	// The last 32 KiB of output, for resolving length-distance copies.
+	private ByteHistory dictionary;
+	
+	// Recently built codes and scratch arrays for dynamic block headers.
+	private HuffmanTableCache cache;
+	
+	// One of the STATE_* constants.
+	private int state;
+	
+	// Whether the block currently being decoded is the last one in the stream.
+	private boolean isFinalBlock;
+	
+	// Number of bytes left to copy in the current uncompressed block.
+	private int storedRemaining;
+	
+	// Codes of the current Huffman-coded block (distanceCode can be null).
+	private CanonicalCode literalLengthCode;
+	private CanonicalCode distanceCode;
+	
+	// A length-distance copy that did not fit in the previous output array.
+	private int matchRemaining;
+	private int matchDistance;
+	
+	
+	
+	/*---- Constructors ----*/
+	
+	/**
+	 * Constructs a decompressor that reads from the specified bit input stream. No data is read yet.
+	 * @param in the bit input stream to read from (not {@code null})
+	 * @throws NullPointerException if the input stream is {@code null}
+	 */
+	public ResumableDecompressor(BitInputStream in) {
+		this(Objects.requireNonNull(in), null);
+	}
+	
+	
+	/**
+	 * Constructs a decompressor whose input is supplied with {@link #feed(byte[], int, int)}.
+	 */
+	public ResumableDecompressor() {
+		this(null, new PushBitInputStream());
+	}
+	
+	
+	// Constructs a decompressor that reads from the given stream positioned at a block boundary,
+	// where the given bytes (at most 32 KiB, oldest first) are the output that precedes it.
+	ResumableDecompressor(BitInputStream in, byte[] window) {
+		this(Objects.requireNonNull(in), null);
+		if (window.length > 32 * 1024)
+			throw new IllegalArgumentException();
+		for (byte b : window)
+			dictionary.append(b);
+	}
+	
+	
+	private ResumableDecompressor(BitInputStream in, PushBitInputStream pushIn) {
+		input = in != null ? in : pushIn;
+		pushInput = pushIn;
+		needsInput = pushIn != null;
+		stopAtBlockEnds = false;
+		dictionary = new ByteHistory(32 * 1024);
+		cache = new HuffmanTableCache();
+		resetState();
+	}
+	
+	
+	
+	/*---- Methods ----*/
+	
+	/**
+	 * Resets this decompressor to decode a new stream whose input will be fed, discarding any
+	 * input and state of the current stream (even after an exception). The window, scratch
+	 * arrays, input storage and recently built Huffman tables are kept, so that decoding
+	 * many streams with one object allocates nothing once the storage has grown enough.
+	 * @throws IllegalStateException if this decompressor reads from a bit input stream
+	 */
+	public void reset() {
+		if (pushInput == null)
+			throw new IllegalStateException("Input is read from a stream");
+		pushInput.clear();
+		needsInput = true;
+		resetState();
+	}
+	
+	
+	/**
+	 * Resets this decompressor to decode a new stream from the specified bit input stream, in the same way as
+	 * {@link #reset()}. The previous input stream is not closed. This decompressor must not take fed input.
+	 * @param in the bit input stream to read from (not {@code null})
+	 * @throws NullPointerException if the input stream is {@code null}
+	 * @throws IllegalStateException if this decompressor takes fed input
+	 */
+	public void reset(BitInputStream in) {
+		Objects.requireNonNull(in);
+		if (pushInput != null)
+			throw new IllegalStateException("Input is fed by the caller");
+		input = in;
+		resetState();
+	}
+	
+	
+	/**
+	 * Appends the specified bytes to the input of this decompressor, which must have been constructed
+	 * without a bit input stream. The bytes are copied, so the array can be reused after this returns.
+	 * @param b the array to read from (not {@code null})
+	 * @param off the index of the first byte to append
+	 * @param len the number of bytes to append
+	 * @throws NullPointerException if the array is {@code null}
+	 * @throws IndexOutOfBoundsException if the array range is out of bounds
+	 * @throws IllegalStateException if this decompressor reads from a bit input stream
+	 */
+	public void feed(byte[] b, int off, int len) {
+		if (pushInput == null)
+			throw new IllegalStateException("Input is read from a stream");
+		pushInput.feed(b, off, len);
+		if (len > 0)
+			needsInput = false;
+	}
+	
+	
+	/**
+	 * Decompresses data into the specified array range, stopping when the range is full or the
+	 * DEFLATE stream ends. Returns the number of bytes written, which is less than {@code len} only
+	 * at the end of the stream or when fed input runs out. Returns &minus;1 if the stream has ended and
+	 * no bytes were written (but 0 if {@code len} is 0). With fed input, an {@code EOFException} is
+	 * never thrown; instead this returns early (possibly with 0) and {@link #needsInput()} becomes true.
+	 * After any other exception is thrown, this object must not be used further until it is reset.
+	 * @param b the array to write to (not {@code null})
+	 * @param off the index in the array to write the first byte to
+	 * @param len the maximum number of bytes to write
+	 * @return the number of bytes written, or &minus;1 at the end of the stream
+	 * @throws NullPointerException if the array is {@code null}
+	 * @throws IndexOutOfBoundsException if the array range is out of bounds
+	 * @throws EOFException if the input stream ends before the DEFLATE data does
+	 * @throws DataFormatException if the DEFLATE data is malformed
+	 */
+	public int decompress(byte[] b, int off, int len) throws IOException, DataFormatException {
+		Objects.requireNonNull(b);
+		if (off < 0 || len < 0 || off > b.length - len)
+			throw new IndexOutOfBoundsException();
+		
+		int start = off;
+		int end = off + len;
+		try {
+			while (off < end) {
+				// Each iteration reads one whole item and only then changes the state, so with fed
+				// input it can be undone by returning to the mark and redone with more input
+				if (pushInput != null)
+					pushInput.mark();
+				
+				if (matchRemaining > 0) {
+					int n = Math.min(matchRemaining, end - off);
+					dictionary.copy(matchDistance, n, b, off);
+					off += n;
+					matchRemaining -= n;
+				} else if (state == STATE_HUFFMAN) {
+					int sym = literalLengthCode.decodeNextSymbol(input);
+					if (sym < 256) {  // Literal byte
+						b[off] = (byte)sym;
+						off++;
+						dictionary.append(sym);
+					} else if (sym == 256) {  // End of block
+						endBlock();
+						if (stopAtBlockEnds)
+							break;
+					} else {  // Length and distance for copying
+						int run = Decompressor.decodeRunLength(sym, input);
+						if (run < 3 || run > 258)
+							throw new AssertionError("Invalid run length");
+						if (distanceCode == null)
+							throw new DataFormatException("Length symbol encountered with empty distance code");
+						int distSym = distanceCode.decodeNextSymbol(input);
+						int dist = Decompressor.decodeDistance(distSym, input);
+						if (dist < 1 || dist > 32768)
+							throw new AssertionError("Invalid distance");
+						matchRemaining = run;
+						matchDistance = dist;
+					}
+				} else if (state == STATE_STORED) {
+					if (storedRemaining == 0) {
+						endBlock();
+						if (stopAtBlockEnds)
+							break;
+					} else if (input instanceof PeekableBitInputStream) {
+						// Copy as many bytes as fit and are available, in bulk
+						int n = ((PeekableBitInputStream)input).readBytes(b, off, Math.min(storedRemaining, end - off));
+						if (n == 0)
+							throw pushInput != null ? pushInput.underflow() : new EOFException();
+						dictionary.append(b, off, n);
+						off += n;
+						storedRemaining -= n;
+					} else {
+						int x = input.readByte();
+						if (x == -1)
+							throw pushInput != null ? pushInput.underflow() : new EOFException();
+						b[off] = (byte)x;
+						off++;
+						dictionary.append(x);
+						storedRemaining--;
+					}
+				} else if (state == STATE_BLOCK_HEADER)
+					readBlockHeader();
+				else if (state == STATE_DONE)
+					break;
+				else
+					throw new AssertionError("Impossible state");
+			}
+		} catch (EOFException e) {
+			if (pushInput == null)
+				throw e;
+			// More input is needed to finish the current item
+			pushInput.reset();
+			needsInput = true;
+			return off - start;
+		}
+		
+		int result = off - start;
+		if (result == 0 && len > 0 && state == STATE_DONE)
+			return -1;
+		return result;
+	}
+	
+	
+	/**
+	 * Tests whether the end of the DEFLATE stream has been decoded. This can be {@code false} even after
+	 * all the output has been returned, if the end-of-block code has not been read yet; in that case the
+	 * next call to {@code decompress()} reads it and returns &minus;1. The input stream is not read by this method.
+	 * @return whether decompression has finished
+	 */
+	public boolean isFinished() {
+		return state == STATE_DONE;
+	}
+	
+	
+	/**
+	 * Tests whether the last call to {@code decompress()} stopped because the fed input ran out, and no
+	 * input has been fed since. Initially true for a decompressor that takes fed input, and always false otherwise.
+	 * @return whether more input must be fed before decompression can make progress
+	 */
+	public boolean needsInput() {
+		return needsInput;
+	}
+	
+	
+	/**
+	 * Returns the number of fed bytes that have not been used. After the stream has finished,
+	 * these are the bytes that follow the DEFLATE data (such as a container's trailer).
+	 * @return the number of unused fed bytes
+	 * @throws IllegalStateException if this decompressor reads from a bit input stream
+	 */
+	public int getRemaining() {
+		if (pushInput == null)
+			throw new IllegalStateException("Input is read from a stream");
+		return pushInput.getRemaining();
+	}
+	
+	
+	private void resetState() {
+		dictionary.reset();
+		state = STATE_BLOCK_HEADER;
+		isFinalBlock = false;
+		storedRemaining = 0;
+		literalLengthCode = null;
+		distanceCode = null;
+		matchRemaining = 0;
+		matchDistance = 0;
+	}
+	
+	
+	// Makes decompress() also return right after the end of each block (possibly with 0 bytes).
+	void setStopAtBlockEnds(boolean stop) {
+		stopAtBlockEnds = stop;
+	}
+	
+	
+	// Tests whether decoding is between two blocks, with no copy pending (so that it can be restarted from here).
+	boolean isAtBlockBoundary() {
+		return state == STATE_BLOCK_HEADER && matchRemaining == 0;
+	}
+	
+	
+	// Returns the last 32 KiB of output, oldest first (with zeros before the start of output).
+	byte[] getWindow() {
+		return dictionary.toByteArray();
+	}
+	
+	
+	// Reads the header of the next block (and for a dynamic Huffman
+	// block, its code definitions), and enters the block's state.
+	private void readBlockHeader() throws IOException, DataFormatException {
+		// For fed input, nothing is changed until the whole header has been read
+		boolean isFinal = input.readNoEof() == 1;  // bfinal
+		int type = Decompressor.readInt(2, input);  // btype
+		
+		if (type == 0) {
+			// Discard bits to align to byte boundary
+			while (input.getBitPosition() != 0)
+				input.readNoEof();
+			
+			int len  = Decompressor.readInt(16, input);
+			int nlen = Decompressor.readInt(16, input);
+			if ((len ^ 0xFFFF) != nlen)
+				throw new DataFormatException("Invalid length in uncompressed block");
+			storedRemaining = len;
+			state = STATE_STORED;
+			isFinalBlock = isFinal;
+		} else if (type == 1) {
+			literalLengthCode = Decompressor.FIXED_LITERAL_LENGTH_CODE;
+			distanceCode = Decompressor.FIXED_DISTANCE_CODE;
+			state = STATE_HUFFMAN;
+			isFinalBlock = isFinal;
+		} else if (type == 2) {
+			CanonicalCode[] litLenAndDist = Decompressor.decodeHuffmanCodes(input, cache);
+			literalLengthCode = litLenAndDist[0];
+			distanceCode = litLenAndDist[1];
+			state = STATE_HUFFMAN;
+			isFinalBlock = isFinal;
+		} else if (type == 3)
+			throw new DataFormatException("Reserved block type");
+		else
+			throw new AssertionError("Impossible value");
+	}
+	
+	
+	private void endBlock() {
+		literalLengthCode = null;
+		distanceCode = null;
+		state = isFinalBlock ? STATE_DONE : STATE_BLOCK_HEADER;
+	}
+	
+	
+	
+	/*---- Constants ----*/
+	
+	private static final int STATE_BLOCK_HEADER = 0;  // Before the next block header
+	private static final int STATE_STORED       = 1;  // Inside an uncompressed block
+	private static final int STATE_HUFFMAN      = 2;  // Inside a Huffman-coded block
+	private static final int STATE_DONE         = 3;  // After the final block
+	
+}
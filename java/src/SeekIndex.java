@@ -0,0 +1,283 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.io.ByteArrayOutputStream;
+import java.io.DataInputStream;
+import java.io.DataOutputStream;
+import java.io.EOFException;
+import java.io.IOException;
+import java.io.InputStream;
+import java.io.OutputStream;
+import java.nio.ByteBuffer;
+import java.util.ArrayList;
+import java.util.Arrays;
+import java.util.List;
+import java.util.Objects;
+import java.util.zip.DataFormatException;
+import java.util.zip.Deflater;
+
+
+/**
+ * An index of checkpoints into a raw DEFLATE stream, which allows decompressing from the middle of the
+ * stream without decoding everything before it. Each checkpoint is at a block boundary and records the
+ * bit offset in the compressed data, the offset in the decompressed data, and the 32 KiB of output
+ * preceding it (stored compressed). For a gzip or zlib file, the index covers the DEFLATE data after
+ * the header, and the buffer given to the methods must be positioned there. Immutable.
+ * <p>On-disk format (big endian): the magic bytes "DFIX", the format version (1 byte), the
+ * number of checkpoints (int32), the uncompressed size (int64), and for each checkpoint the bit
+ * offset (int64), the uncompressed offset (int64), the length of the compressed window (int32),
+ * and the window as raw DEFLATE data (the last min(32 KiB, uncompressed offset) bytes).</p>
+ */
+public final class SeekIndex {
+	
+	/*---- Fields ----*/
+	
+	// Checkpoint data, in ascending order by both offsets. The first checkpoint is at the start of the stream.
+	private long[] bitOffsets;
+	private long[] uncompressedOffsets;
+	private byte[][] compressedWindows;
+	
+	private long uncompressedSize;
+	
+	
+	
+	/*---- Factory methods and constructor ----*/
+	
+	/**
+	 * Decompresses the DEFLATE data starting at the specified buffer's position, and returns an index with a
+	 * checkpoint at the first block boundary after every {@code spacing} bytes of output. On success the buffer's
+	 * position is advanced to just after the end of the DEFLATE data. The decompressed data is discarded.
+	 * @param in the byte buffer to read from (not {@code null})
+	 * @param spacing the minimum number of decompressed bytes between checkpoints, which must be positive
+	 * @return an index of the DEFLATE data (not {@code null})
+	 * @throws NullPointerException if the buffer is {@code null}
+	 * @throws IllegalArgumentException if the spacing is not positive
+	 * @throws EOFException if the buffer ends before the DEFLATE data does
+	 * @throws DataFormatException if the DEFLATE data is malformed
+	 */
+	public static SeekIndex build(ByteBuffer in, long spacing) throws IOException, DataFormatException {
+		Objects.requireNonNull(in);
+		if (spacing < 1)
+			throw new IllegalArgumentException("Spacing must be positive");
+		ByteBufferBitInputStream bitIn = new ByteBufferBitInputStream(in.slice());
+		ResumableDecompressor decomp = new ResumableDecompressor(bitIn);
+		decomp.setStopAtBlockEnds(true);
+		
+		List<long[]> offsets = new ArrayList<>();
+		List<byte[]> windows = new ArrayList<>();
+		offsets.add(new long[]{0, 0});
+		windows.add(compressWindow(new byte[0]));
+		
+		byte[] buf = new byte[64 * 1024];
+		long size = 0;
+		long nextCheckpoint = spacing;
+		while (true) {
+			int n = decomp.decompress(buf, 0, buf.length);
+			if (n == -1)
+				break;
+			size += n;
+			if (size >= nextCheckpoint && decomp.isAtBlockBoundary() && !decomp.isFinished()) {
+				byte[] window = decomp.getWindow();
+				if (size < window.length)
+					window = Arrays.copyOfRange(window, window.length - (int)size, window.length);
+				offsets.add(new long[]{bitIn.getBitOffset(), size});
+				windows.add(compressWindow(window));
+				nextCheckpoint = size + spacing;
+			}
+		}
+		in.position(in.position() + bitIn.getPosition());
+		
+		long[] bitOffsets = new long[offsets.size()];
+		long[] uncompOffsets = new long[offsets.size()];
+		for (int i = 0; i < bitOffsets.length; i++) {
+			bitOffsets[i] = offsets.get(i)[0];
+			uncompOffsets[i] = offsets.get(i)[1];
+		}
+		return new SeekIndex(bitOffsets, uncompOffsets, windows.toArray(new byte[0][]), size);
+	}
+	
+	
+	/**
+	 * Reads an index in the on-disk format from the specified input stream.
+	 * @param in the input stream to read from (not {@code null})
+	 * @return the index that was read (not {@code null})
+	 * @throws NullPointerException if the input stream is {@code null}
+	 * @throws EOFException if the stream ends before the index does
+	 * @throws DataFormatException if the data is not a valid index
+	 */
+	public static SeekIndex readFrom(InputStream in) throws IOException, DataFormatException {
+		DataInputStream din = new DataInputStream(Objects.requireNonNull(in));
+		byte[] magic = new byte[MAGIC.length];
+		din.readFully(magic);
+		if (!Arrays.equals(magic, MAGIC))
+			throw new DataFormatException("Invalid index magic number");
+		int version = din.readUnsignedByte();
+		if (version != VERSION)
+			throw new DataFormatException("Unsupported index version: " + version);
+		int count = din.readInt();
+		long size = din.readLong();
+		if (count < 1 || size < 0)
+			throw new DataFormatException("Invalid index header");
+		
+		long[] bitOffsets = new long[count];
+		long[] uncompOffsets = new long[count];
+		byte[][] windows = new byte[count][];
+		for (int i = 0; i < count; i++) {
+			bitOffsets[i] = din.readLong();
+			uncompOffsets[i] = din.readLong();
+			int len = din.readInt();
+			if (len < 0 || len > MAX_COMPRESSED_WINDOW)
+				throw new DataFormatException("Invalid window length");
+			windows[i] = new byte[len];
+			din.readFully(windows[i]);
+		}
+		if (bitOffsets[0] != 0 || uncompOffsets[0] != 0)
+			throw new DataFormatException("First checkpoint must be at the start");
+		for (int i = 1; i < count; i++) {
+			if (bitOffsets[i] <= bitOffsets[i - 1] || uncompOffsets[i] < uncompOffsets[i - 1] || uncompOffsets[i] > size)
+				throw new DataFormatException("Checkpoints out of order");
+		}
+		return new SeekIndex(bitOffsets, uncompOffsets, windows, size);
+	}
+	
+	
+	private SeekIndex(long[] bitOffsets, long[] uncompOffsets, byte[][] windows, long size) {
+		this.bitOffsets = bitOffsets;
+		this.uncompressedOffsets = uncompOffsets;
+		this.compressedWindows = windows;
+		this.uncompressedSize = size;
+	}
+	
+	
+	
+	/*---- Methods ----*/
+	
+	/**
+	 * Returns the total length of the decompressed data.
+	 * @return the decompressed size, at least 0
+	 */
+	public long getUncompressedSize() {
+		return uncompressedSize;
+	}
+	
+	
+	/**
+	 * Returns the number of checkpoints in this index, which is at least 1.
+	 * @return the number of checkpoints
+	 */
+	public int getCheckpointCount() {
+		return bitOffsets.length;
+	}
+	
+	
+	/**
+	 * Decompresses bytes starting at the specified offset of the decompressed data into the specified array range,
+	 * decoding from the nearest checkpoint at or before the offset. The buffer must hold the same DEFLATE data
+	 * that this index was built from, starting at its position; the buffer's position is not changed.
+	 * Returns the number of bytes written, which is less than {@code len} only at the end of the data,
+	 * or &minus;1 if the offset is at or past the end (and {@code len} is positive).
+	 * @param in the byte buffer holding the DEFLATE data (not {@code null})
+	 * @param offset the offset in the decompressed data to start at, at least 0
+	 * @param b the array to write to (not {@code null})
+	 * @param off the index in the array to write the first byte to
+	 * @param len the maximum number of bytes to write
+	 * @return the number of bytes written, or &minus;1 at the end of the data
+	 * @throws NullPointerException if the buffer or array is {@code null}
+	 * @throws IllegalArgumentException if the offset is negative
+	 * @throws IndexOutOfBoundsException if the array range is out of bounds
+	 * @throws EOFException if the buffer ends before the DEFLATE data does
+	 * @throws DataFormatException if the DEFLATE data is malformed or does not match this index
+	 */
+	public int read(ByteBuffer in, long offset, byte[] b, int off, int len) throws IOException, DataFormatException {
+		Objects.requireNonNull(in);
+		Objects.requireNonNull(b);
+		if (offset < 0)
+			throw new IllegalArgumentException("Negative offset");
+		if (off < 0 || len < 0 || off > b.length - len)
+			throw new IndexOutOfBoundsException();
+		if (len == 0)
+			return 0;
+		if (offset >= uncompressedSize)
+			return -1;
+		
+		// Find the last checkpoint at or before the offset
+		int i = Arrays.binarySearch(uncompressedOffsets, offset);
+		if (i < 0)
+			i = -i - 2;
+		else {  // Checkpoints can share an offset when blocks are empty; take the last one
+			while (i + 1 < uncompressedOffsets.length && uncompressedOffsets[i + 1] == offset)
+				i++;
+		}
+		
+		// Restart decoding there and skip to the offset
+		byte[] window = Decompressor.decompress(ByteBuffer.wrap(compressedWindows[i]));
+		if (window.length != Math.min(uncompressedOffsets[i], 32 * 1024))
+			throw new DataFormatException("Invalid window in index");
+		BitInputStream bitIn = ByteBufferBitInputStream.openAtBitOffset(in.slice(), bitOffsets[i]);
+		ResumableDecompressor decomp = new ResumableDecompressor(bitIn, window);
+		byte[] skipBuf = new byte[64 * 1024];
+		for (long skip = offset - uncompressedOffsets[i]; skip > 0; ) {
+			int n = decomp.decompress(skipBuf, 0, (int)Math.min(skip, skipBuf.length));
+			if (n < (int)Math.min(skip, skipBuf.length))
+				throw new DataFormatException("DEFLATE data does not match index");
+			skip -= n;
+		}
+		return decomp.decompress(b, off, len);
+	}
+	
+	
+	/**
+	 * Writes this index in the on-disk format to the specified output stream.
+	 * @param out the output stream to write to (not {@code null})
+	 * @throws NullPointerException if the output stream is {@code null}
+	 * @throws IOException if an I/O exception occurred
+	 */
+	public void writeTo(OutputStream out) throws IOException {
+		DataOutputStream dout = new DataOutputStream(Objects.requireNonNull(out));
+		dout.write(MAGIC);
+		dout.writeByte(VERSION);
+		dout.writeInt(bitOffsets.length);
+		dout.writeLong(uncompressedSize);
+		for (int i = 0; i < bitOffsets.length; i++) {
+			dout.writeLong(bitOffsets[i]);
+			dout.writeLong(uncompressedOffsets[i]);
+			dout.writeInt(compressedWindows[i].length);
+			dout.write(compressedWindows[i]);
+		}
+		dout.flush();
+	}
+	
+	
+	// Returns the raw DEFLATE compression of the given window, which is often much smaller than 32 KiB.
+	private static byte[] compressWindow(byte[] window) {
+		Deflater def = new Deflater(Deflater.BEST_COMPRESSION, true);
+		try {
+			def.setInput(window);
+			def.finish();
+			ByteArrayOutputStream bout = new ByteArrayOutputStream();
+			byte[] buf = new byte[4096];
+			while (!def.finished())
+				bout.write(buf, 0, def.deflate(buf));
+			return bout.toByteArray();
+		} finally {
+			def.end();
+		}
+	}
+	
+	
+	
+	/*---- Constants ----*/
+	
+	private static final byte[] MAGIC = {'D', 'F', 'I', 'X'};
+	
+	private static final int VERSION = 1;
+	
+	// Generous bound on the compressed size of 32 KiB, to reject corrupt lengths before allocating.
+	private static final int MAX_COMPRESSED_WINDOW = 64 * 1024;
+	
+}
@@ -0,0 +1,149 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.util.Objects;
+import java.util.concurrent.CancellationException;
+import java.util.concurrent.atomic.AtomicLong;
+import java.util.concurrent.locks.LockSupport;
+
+
+/**
+ * A bounded lock-free queue for exactly one producer thread and one consumer thread, which connects the stages of
+ * a pipeline. The producer only writes the tail counter and the consumer only writes the head counter, each with
+ * an ordered store that publishes the element slot, so no locks or compare-and-set loops are needed. A thread
+ * that finds the ring full or empty spins briefly and then parks for short intervals. Any thread can close the
+ * ring to stop the pipeline, which makes waiting and later blocking calls throw {@link CancellationException}.
+ * @param <E> the type of elements
+ */
+final class SpscRing<E> {
+	
+	/*---- Fields ----*/
+	
+	private final Object[] elements;
+	
+	private final int mask;  // elements.length - 1
+	
+	// Number of elements ever taken, written only by the consumer.
+	private final AtomicLong head = new AtomicLong();
+	
+	// Number of elements ever added, written only by the producer.
+	private final AtomicLong tail = new AtomicLong();
+	
+	private volatile boolean closed = false;
+	
+	
+	
+	/*---- Constructor ----*/
+	
+	/**
+	 * Constructs an empty ring with the specified capacity.
+	 * @param capacity the maximum number of elements, which must be a positive power of 2
+	 * @throws IllegalArgumentException if the capacity is not a positive power of 2
+	 */
+	public SpscRing(int capacity) {
+		if (capacity < 1 || Integer.bitCount(capacity) != 1)
+			throw new IllegalArgumentException("Capacity must be a positive power of 2");
+		elements = new Object[capacity];
+		mask = capacity - 1;
+	}
+	
+	
+	
+	/*---- Methods ----*/
+	
+	/**
+	 * Adds the specified element if the ring is not full, without waiting. Only the producer may call this.
+	 * @param elem the element to add (not {@code null})
+	 * @return whether the element was added
+	 * @throws NullPointerException if the element is {@code null}
+	 */
+	public boolean offer(E elem) {
+		Objects.requireNonNull(elem);
+		long t = tail.get();
+		if (t - head.get() == elements.length)
+			return false;
+		elements[(int)t & mask] = elem;
+		tail.lazySet(t + 1);  // Publishes the slot to the consumer
+		return true;
+	}
+	
+	
+	/**
+	 * Removes and returns the oldest element, or returns {@code null} if the ring is empty, without waiting.
+	 * Only the consumer may call this.
+	 * @return the oldest element, or {@code null} if none
+	 */
+	@SuppressWarnings("unchecked")
+	public E poll() {
+		long h = head.get();
+		if (h == tail.get())
+			return null;
+		int i = (int)h & mask;
+		E result = (E)elements[i];
+		elements[i] = null;
+		head.lazySet(h + 1);  // Hands the slot back to the producer
+		return result;
+	}
+	
+	
+	/**
+	 * Adds the specified element, waiting while the ring is full. Only the producer may call this.
+	 * @param elem the element to add (not {@code null})
+	 * @throws NullPointerException if the element is {@code null}
+	 * @throws CancellationException if the ring is or becomes closed while waiting, or the thread is interrupted
+	 */
+	public void put(E elem) {
+		for (int i = 0; !offer(elem); i++)
+			pause(i);
+	}
+	
+	
+	/**
+	 * Removes and returns the oldest element, waiting while the ring is empty. Only the consumer may call this.
+	 * @return the oldest element (not {@code null})
+	 * @throws CancellationException if the ring is or becomes closed while waiting, or the thread is interrupted
+	 */
+	public E take() {
+		for (int i = 0; ; i++) {
+			E result = poll();
+			if (result != null)
+				return result;
+			pause(i);
+		}
+	}
+	
+	
+	/**
+	 * Closes this ring, so that threads waiting on it stop. Elements already in the ring can still be polled.
+	 */
+	public void close() {
+		closed = true;
+	}
+	
+	
+	// Waits a little before the given numbered retry, or throws if the pipeline is stopping.
+	private void pause(int retry) {
+		if (closed)
+			throw new CancellationException("Pipeline stopped");
+		if (Thread.interrupted()) {
+			closed = true;
+			throw new CancellationException("Interrupted");
+		}
+		if (retry < SPIN_LIMIT)
+			Thread.yield();
+		else
+			LockSupport.parkNanos(PARK_NANOS);
+	}
+	
+	
+	// Retries that yield before parking, which covers brief waits with the least latency.
+	private static final int SPIN_LIMIT = 100;
+	
+	private static final long PARK_NANOS = 50 * 1000;
+	
+}
@@ -0,0 +1,71 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.io.IOException;
+import java.io.OutputStream;
+import java.util.Objects;
+
+
+/**
+ * An output window that writes to an output stream, and keeps
+ * the last 32 KiB in a byte history. Mutable and not thread-safe.
+ */
+final class StreamOutputWindow implements OutputWindow {
+	
+	/*---- Fields ----*/
+	
+	private OutputStream output;
+	
+	private ByteHistory dictionary;
+	
+	
+	
+	/*---- Constructor ----*/
+	
+	/**
+	 * Constructs an output window that writes to the specified output stream.
+	 * @param out the output stream to write to (not {@code null})
+	 * @throws NullPointerException if the output stream is {@code null}
+	 */
+	public StreamOutputWindow(OutputStream out) {
+		output = Objects.requireNonNull(out);
+		dictionary = new ByteHistory(32 * 1024);
+	}
+	
+	
+	
+	/*---- Methods ----*/
+	
+	public void append(int b) throws IOException {
+		output.write(b);
+		dictionary.append(b);
+	}
+	
+	
+	public void append(byte[] b, int off, int len) throws IOException {
+		output.write(b, off, len);
+		dictionary.append(b, off, len);
+	}
+	
+	
+	public int appendFrom(PeekableBitInputStream in, int len) throws IOException {
+		return dictionary.appendFrom(in, len, output);
+	}
+	
+	
+	public void copy(int dist, int len) throws IOException {
+		dictionary.copy(dist, len, output);
+	}
+	
+	
+	// Returns a new array of the last 32 KiB of output from oldest to newest, with zeros before the start of the output.
+	byte[] getHistory() {
+		return dictionary.toByteArray();
+	}
+	
+}
@@ -0,0 +1,192 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.io.ByteArrayOutputStream;
+import java.io.EOFException;
+import java.io.IOException;
+import java.io.OutputStream;
+import java.util.Arrays;
+import java.util.Objects;
+import java.util.zip.DataFormatException;
+
+
+/**
+ * Decompresses data in the zlib format (RFC 1950), which wraps raw DEFLATE data with a 2-byte header,
+ * an optional preset dictionary identifier, and an Adler-32 checksum of the decompressed data.
+ * The checksum is updated over each piece of output as it is produced.
+ */
+public final class ZlibDecompressor {
+	
+	/*---- Public functions ----*/
+	
+	/**
+	 * Reads a zlib stream from the specified input stream, decompresses it, and returns a new byte array.
+	 * On success the input stream is positioned just after the checksum.
+	 * @param in the bit input stream to read from, at a byte boundary (not {@code null})
+	 * @param dictionary the preset dictionary, or {@code null} if none is available;
+	 * it is only used if the stream's header asks for one
+	 * @return the decompressed data (not {@code null})
+	 * @throws NullPointerException if the input stream is {@code null}
+	 * @throws EOFException if the input stream ends before the zlib data does
+	 * @throws DataFormatException if the zlib data is malformed, the checksum mismatches,
+	 * or the stream needs a dictionary that was not given or does not match
+	 */
+	public static byte[] decompress(BitInputStream in, byte[] dictionary) throws IOException, DataFormatException {
+		ByteArrayOutputStream out = new ByteArrayOutputStream();
+		decompress(in, out, dictionary);
+		return out.toByteArray();
+	}
+	
+	
+	/**
+	 * Reads a zlib stream from the specified input stream, decompresses it, and writes to the specified
+	 * output stream. On success the input stream is positioned just after the checksum. If an exception
+	 * is thrown, the data written so far has not been verified by the checksum.
+	 * @param in the bit input stream to read from, at a byte boundary (not {@code null})
+	 * @param out the byte output stream to write to (not {@code null})
+	 * @param dictionary the preset dictionary, or {@code null} if none is available;
+	 * it is only used if the stream's header asks for one
+	 * @throws NullPointerException if the input or output stream is {@code null}
+	 * @throws EOFException if the input stream ends before the zlib data does
+	 * @throws DataFormatException if the zlib data is malformed, the checksum mismatches,
+	 * or the stream needs a dictionary that was not given or does not match
+	 */
+	public static void decompress(BitInputStream in, OutputStream out, byte[] dictionary) throws IOException, DataFormatException {
+		decompress(in, out, dictionary, UNLIMITED);
+	}
+	
+	
+	/**
+	 * Reads a zlib stream from the specified input stream, decompresses it, and writes to the specified output
+	 * stream, stopping as soon as the output would exceed the specified limits. The limits are checked before each
+	 * piece of at most 64 KiB is written, so no output beyond the byte limit is ever written. The ratio is of the
+	 * output to the DEFLATE data consumed, not counting the zlib header. On success the input stream is positioned
+	 * just after the checksum. If an exception is thrown, the data written so far has not been verified by the
+	 * checksum, so the caller should discard it.
+	 * @param in the bit input stream to read from, at a byte boundary (not {@code null})
+	 * @param out the byte output stream to write to (not {@code null})
+	 * @param dictionary the preset dictionary, or {@code null} if none is available;
+	 * it is only used if the stream's header asks for one
+	 * @param limits the limits on the output (not {@code null})
+	 * @throws NullPointerException if the input stream, output stream, or limits is {@code null}
+	 * @throws EOFException if the input stream ends before the zlib data does
+	 * @throws DecompressionLimitException if the output would exceed a limit
+	 * @throws DataFormatException if the zlib data is malformed, the checksum mismatches,
+	 * or the stream needs a dictionary that was not given or does not match
+	 */
+	public static void decompress(BitInputStream in, OutputStream out, byte[] dictionary, DecompressionLimits limits) throws IOException, DataFormatException {
+		Objects.requireNonNull(in);
+		Objects.requireNonNull(out);
+		Objects.requireNonNull(limits);
+		
+		// Header: compression method and info, then flags with a check of both bytes
+		int cmf = readUnsignedByte(in);
+		int flg = readUnsignedByte(in);
+		if ((cmf << 8 | flg) % 31 != 0)
+			throw new DataFormatException("Invalid zlib header check");
+		if ((cmf & 0xF) != 8)
+			throw new DataFormatException("Unsupported compression method: " + (cmf & 0xF));
+		if ((cmf >>> 4) > 7)
+			throw new DataFormatException("Unsupported window size");
+		
+		// Preset dictionary, of which only the last 32 KiB can be referenced
+		byte[] window = new byte[0];
+		if ((flg & 0x20) != 0) {
+			int dictId = readBigEndianInt32(in);
+			if (dictionary == null)
+				throw new DataFormatException("Preset dictionary required");
+			if (updateAdler32(1, dictionary, 0, dictionary.length) != dictId)
+				throw new DataFormatException("Preset dictionary mismatch");
+			window = Arrays.copyOfRange(dictionary, Math.max(dictionary.length - 32 * 1024, 0), dictionary.length);
+		}
+		
+		// Decompress, checksumming each piece while it is still in cache. A piece is at most
+		// one byte more than the output limit allows, so that going over it is detected.
+		Decompressor.CountingBitInputStream counter = null;
+		if (limits.maxRatio != Double.POSITIVE_INFINITY)
+			counter = new Decompressor.CountingBitInputStream(in);
+		ResumableDecompressor decomp = new ResumableDecompressor(counter != null ? counter : in, window);
+		byte[] buf = new byte[64 * 1024];
+		int adler = 1;
+		long outputBytes = 0;
+		while (true) {
+			int n = decomp.decompress(buf, 0, (int)Math.min(buf.length - 1, limits.maxOutputBytes - outputBytes) + 1);
+			if (n == -1)
+				break;
+			outputBytes += n;
+			if (outputBytes > limits.maxOutputBytes)
+				throw new DecompressionLimitException("Output exceeds " + limits.maxOutputBytes + " bytes");
+			if (counter != null && outputBytes > DecompressionLimits.RATIO_GRACE_BYTES
+					&& outputBytes > limits.maxRatio * ((counter.bitCount + 7) >>> 3))
+				throw new DecompressionLimitException("Expansion ratio exceeds " + limits.maxRatio);
+			adler = updateAdler32(adler, buf, 0, n);
+			out.write(buf, 0, n);
+		}
+		
+		int expectAdler = readBigEndianInt32(in);  // Discards the rest of the current byte first
+		if (expectAdler != adler)
+			throw new DataFormatException(String.format("Adler-32 mismatch: expected=%08X, actual=%08X", expectAdler, adler));
+	}
+	
+	
+	
+	/*---- Private implementation ----*/
+	
+	// Returns the Adler-32 checksum of the concatenation of the data that gave the specified checksum and the
+	// specified array range. The sums are reduced modulo 65521 only once per chunk of ADLER_CHUNK_SIZE bytes,
+	// and within a chunk four bytes are added per step so that the two sums have short dependency chains.
+	static int updateAdler32(int adler, byte[] b, int off, int len) {
+		int s1 = adler & 0xFFFF;
+		int s2 = adler >>> 16;
+		while (len > 0) {
+			int n = Math.min(len, ADLER_CHUNK_SIZE);
+			len -= n;
+			int end = off + n;
+			for (; end - off >= 4; off += 4) {
+				int b0 = b[off + 0] & 0xFF;
+				int b1 = b[off + 1] & 0xFF;
+				int b2 = b[off + 2] & 0xFF;
+				int b3 = b[off + 3] & 0xFF;
+				s2 += s1 * 4 + b0 * 4 + b1 * 3 + b2 * 2 + b3;
+				s1 += b0 + b1 + b2 + b3;
+			}
+			for (; off < end; off++) {
+				s1 += b[off] & 0xFF;
+				s2 += s1;
+			}
+			s1 %= ADLER_MODULUS;
+			s2 %= ADLER_MODULUS;
+		}
+		return s2 << 16 | s1;
+	}
+	
+	
+	private static int readUnsignedByte(BitInputStream in) throws IOException {
+		int result = in.readByte();
+		if (result == -1)
+			throw new EOFException();
+		return result;
+	}
+	
+	
+	private static int readBigEndianInt32(BitInputStream in) throws IOException {
+		int result = 0;
+		for (int i = 0; i < 4; i++)
+			result = result << 8 | readUnsignedByte(in);
+		return result;
+	}
+	
+	
+	private static final DecompressionLimits UNLIMITED = new DecompressionLimits(Long.MAX_VALUE, Double.POSITIVE_INFINITY);
+	
+	private static final int ADLER_MODULUS = 65521;
+	
+	// The largest multiple of 4 such that the sums cannot exceed Integer.MAX_VALUE, starting from values below the modulus.
+	private static final int ADLER_CHUNK_SIZE = 3852;
+	
+}
@@ -0,0 +1,167 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.io.ByteArrayOutputStream;
+import java.io.EOFException;
+import java.io.IOException;
+import java.nio.charset.StandardCharsets;
+import java.util.Arrays;
+import java.util.Random;
+import java.util.concurrent.ForkJoinPool;
+import java.util.zip.DataFormatException;
+import java.util.zip.Deflater;
+import org.junit.Assert;
+import org.junit.Test;
+
+
+public final class BatchDecompressorTest {
+	
+	@Test public void testRandomly() throws IOException, DataFormatException {
+		for (int i = 0; i < 30; i++) {
+			int numStreams = rand.nextInt(3000);
+			byte[][] datas = new byte[numStreams][];
+			byte[][] buffers = new byte[numStreams][];
+			int[] offsets = new int[numStreams];
+			int[] lengths = new int[numStreams];
+			
+			// Most streams lie in one shared array with gaps between them, and the rest have their own arrays
+			ByteArrayOutputStream shared = new ByteArrayOutputStream();
+			for (int j = 0; j < numStreams; j++) {
+				byte[] data = new byte[rand.nextInt(300)];
+				for (int k = 0; k < data.length; k++)
+					data[k] = (byte)('a' + rand.nextInt(rand.nextInt(26) + 1));
+				datas[j] = data;
+				byte[] comp = compress(data, rand.nextInt(10));
+				if (rand.nextInt(4) == 0) {
+					buffers[j] = Arrays.copyOf(comp, comp.length + rand.nextInt(3));  // Possibly with trailing bytes
+					lengths[j] = buffers[j].length;
+				} else {
+					shared.write(rand.nextInt(256));
+					offsets[j] = shared.size();
+					lengths[j] = comp.length;
+					shared.write(comp, 0, comp.length);
+				}
+			}
+			byte[] sharedArray = shared.toByteArray();
+			for (int j = 0; j < numStreams; j++) {
+				if (buffers[j] == null)
+					buffers[j] = sharedArray;
+			}
+			
+			checkResult(datas, BatchDecompressor.decompress(buffers, offsets, lengths));
+			checkResult(datas, BatchDecompressor.decompress(buffers, offsets, lengths, POOL));
+		}
+	}
+	
+	
+	@Test public void testNoReferenceToPreviousStream() throws IOException, DataFormatException {
+		// The second stream is a fixed Huffman block that copies 3 bytes at distance 1 before any output
+		byte[] first = compress("abc".getBytes(StandardCharsets.US_ASCII), 6);
+		byte[] second = {0x03, 0x02, 0x00};
+		BatchDecompressor.Result r = BatchDecompressor.decompress(new byte[][]{first, second}, new int[2], new int[]{first.length, second.length});
+		Assert.assertArrayEquals(new int[]{0, 3, 6}, r.offsets);
+		Assert.assertArrayEquals(new byte[]{'a', 'b', 'c', 0, 0, 0}, r.data);
+		Assert.assertEquals(3, r.length(1));
+	}
+	
+	
+	@Test public void testMalformedStream() throws IOException {
+		byte[] good = compress(new byte[100], 6);
+		byte[] bad = {0x07};  // Reserved block type
+		try {
+			BatchDecompressor.decompress(new byte[][]{good, good, bad}, new int[3], new int[]{good.length, good.length, 1});
+			Assert.fail();
+		} catch (DataFormatException e) {
+			Assert.assertTrue(e.getMessage().startsWith("Stream 2: "));
+		}
+	}
+	
+	
+	@Test public void testMalformedStreamPooled() throws IOException {
+		// Enough streams for the batch to be split into parts, with the bad one in a later part
+		int numStreams = 3000;
+		byte[] good = compress(new byte[100], 6);
+		byte[][] buffers = new byte[numStreams][];
+		int[] lengths = new int[numStreams];
+		Arrays.fill(buffers, good);
+		Arrays.fill(lengths, good.length);
+		buffers[2000] = new byte[]{0x07};  // Reserved block type
+		lengths[2000] = 1;
+		try {
+			BatchDecompressor.decompress(buffers, new int[numStreams], lengths, POOL);
+			Assert.fail();
+		} catch (DataFormatException e) {
+			Assert.assertTrue(e.getMessage().startsWith("Stream 2000: "));
+		}
+	}
+	
+	
+	@Test(expected=EOFException.class)
+	public void testTruncatedStream() throws IOException, DataFormatException {
+		byte[] comp = compress(new byte[100], 6);
+		BatchDecompressor.decompress(new byte[][]{comp, comp}, new int[2], new int[]{comp.length, comp.length - 1});
+	}
+	
+	
+	@Test public void testTruncatedStreamPooled() throws IOException, DataFormatException {
+		int numStreams = 3000;
+		byte[] comp = compress(new byte[100], 6);
+		byte[][] buffers = new byte[numStreams][];
+		int[] lengths = new int[numStreams];
+		Arrays.fill(buffers, comp);
+		Arrays.fill(lengths, comp.length);
+		lengths[2999] = comp.length - 1;
+		try {
+			BatchDecompressor.decompress(buffers, new int[numStreams], lengths, POOL);
+			Assert.fail();
+		} catch (EOFException e) {
+			Assert.assertEquals("Stream 2999 is truncated", e.getMessage());
+		}
+	}
+	
+	
+	@Test(expected=IllegalArgumentException.class)
+	public void testArrayLengthMismatch() throws IOException, DataFormatException {
+		BatchDecompressor.decompress(new byte[2][0], new int[2], new int[1]);
+	}
+	
+	
+	@Test(expected=IndexOutOfBoundsException.class)
+	public void testRangeOutOfBounds() throws IOException, DataFormatException {
+		BatchDecompressor.decompress(new byte[][]{new byte[10]}, new int[]{5}, new int[]{6});
+	}
+	
+	
+	private static void checkResult(byte[][] datas, BatchDecompressor.Result r) {
+		Assert.assertEquals(datas.length + 1, r.offsets.length);
+		Assert.assertEquals(0, r.offsets[0]);
+		Assert.assertEquals(r.data.length, r.offsets[datas.length]);
+		for (int i = 0; i < datas.length; i++)
+			Assert.assertArrayEquals(datas[i], Arrays.copyOfRange(r.data, r.offsets[i], r.offsets[i + 1]));
+	}
+	
+	
+	// Returns the raw DEFLATE compression of the given data at the given level.
+	private static byte[] compress(byte[] data, int level) {
+		Deflater def = new Deflater(level, true);
+		def.setInput(data);
+		def.finish();
+		ByteArrayOutputStream bout = new ByteArrayOutputStream();
+		byte[] buf = new byte[4096];
+		while (!def.finished())
+			bout.write(buf, 0, def.deflate(buf));
+		def.end();
+		return bout.toByteArray();
+	}
+	
+	
+	private static final ForkJoinPool POOL = new ForkJoinPool(4);
+	
+	private static Random rand = new Random();
+	
+}
@@ -0,0 +1,84 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.List;
+import java.util.Random;
+import org.junit.Assert;
+import org.junit.Test;
+
+
+public final class BlockDecodeTableTest {
+	
+	@Test public void testRandomly() {
+		for (int i = 0; i < 300; i++) {
+			CanonicalCode litLenCode = new CanonicalCode(randomCodeLengths(rand.nextInt(286) + 2, rand.nextInt(32) + 257));
+			CanonicalCode distCode = new CanonicalCode(randomCodeLengths(rand.nextInt(31) + 2, 32));
+			BlockDecodeTable t = new BlockDecodeTable(litLenCode, distCode);
+			
+			// Every fused lookup must agree with the code's own lookup, translated to the symbol's value
+			for (int j = 0; j < 1000; j++) {
+				int bits = rand.nextInt(1 << 15);
+				int index = (bits & ((1 << t.litLenBits) - 1)) << 1;
+				Assert.assertEquals(litLenCode.lookupLiteralPair(bits), t.table[index]);
+				int entry = t.table[index + 1];
+				if ((entry & 0xF) == 0)
+					entry = t.table[(entry >>> 16) + ((bits >>> t.litLenBits) & ((1 << ((entry >>> 4) & 0xF)) - 1))];
+				int expect = litLenCode.lookup(bits);
+				int sym = expect >>> 4;
+				Assert.assertEquals(expect & 0xF, entry & 0xF);
+				if (sym < 256)
+					Assert.assertEquals(sym << 16 | Decompressor.KIND_LITERAL << 8, entry & ~0xF);
+				else if (sym == 256)
+					Assert.assertEquals(Decompressor.KIND_END_OF_BLOCK << 8, entry & ~0xF);
+				else
+					Assert.assertEquals(Decompressor.LENGTH_SYMBOL_TABLE[sym - 257], entry & ~0xF);
+				
+				entry = t.table[t.distStart + (bits & ((1 << t.distBits) - 1))];
+				if ((entry & 0xF) == 0)
+					entry = t.table[(entry >>> 16) + ((bits >>> t.distBits) & ((1 << ((entry >>> 4) & 0xF)) - 1))];
+				expect = distCode.lookup(bits);
+				Assert.assertEquals(Decompressor.DISTANCE_SYMBOL_TABLE[expect >>> 4] | (expect & 0xF), entry);
+			}
+		}
+	}
+	
+	
+	@Test(expected=IllegalArgumentException.class)
+	public void testTooManyDistanceSymbols() {
+		new BlockDecodeTable(new CanonicalCode(randomCodeLengths(2, 288)), new CanonicalCode(randomCodeLengths(2, 33)));
+	}
+	
+	
+	// Returns the code lengths of a random full code tree with the given number of used symbols, possibly with
+	// codes longer than the primary table, shuffled among the given number of symbols in total.
+	private static int[] randomCodeLengths(int numUsed, int numSymbols) {
+		List<Integer> codeLenList = new ArrayList<>();
+		codeLenList.add(0);
+		while (codeLenList.size() < numUsed) {
+			int j = rand.nextInt(codeLenList.size());
+			int depth = codeLenList.get(j);
+			if (depth < 15) {
+				codeLenList.set(j, depth + 1);
+				codeLenList.add(depth + 1);
+			}
+		}
+		while (codeLenList.size() < numSymbols)
+			codeLenList.add(0);
+		Collections.shuffle(codeLenList, rand);
+		int[] result = new int[codeLenList.size()];
+		for (int i = 0; i < result.length; i++)
+			result[i] = codeLenList.get(i);
+		return result;
+	}
+	
+	
+	private static Random rand = new Random();
+	
+}
@@ -0,0 +1,184 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.io.ByteArrayInputStream;
+import java.io.EOFException;
+import java.io.IOException;
+import java.util.Random;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.fail;
+import org.junit.Test;
+
+
+public final class BufferedBitInputStreamTest {
+	
+	@Test public void testMixedReadBitsAndBytes() throws IOException {
+		for (int bufferSize = 1; bufferSize <= 13; bufferSize++) {
+			BitInputStream in = new BufferedBitInputStream(new ByteArrayInputStream(new byte[] {
+				// Merely a random sequence to prevent accidental repeats
+				(byte)0xB7, (byte)0xC5, (byte)0xBD, (byte)0xDA, (byte)0x5B, (byte)0xD0,
+				(byte)0x3A, (byte)0xD5, (byte)0x19, (byte)0x3A, (byte)0x41, (byte)0xA6,
+			}), bufferSize);
+			
+			// Read bits of 0th byte
+			assertEquals(0, in.getBitPosition());
+			assertEquals(1, in.read());
+			assertEquals(1, in.getBitPosition());
+			assertEquals(1, in.read());
+			assertEquals(2, in.getBitPosition());
+			assertEquals(1, in.read());
+			assertEquals(3, in.getBitPosition());
+			assertEquals(0, in.read());
+			assertEquals(4, in.getBitPosition());
+			assertEquals(1, in.read());
+			assertEquals(5, in.getBitPosition());
+			assertEquals(1, in.read());
+			assertEquals(6, in.getBitPosition());
+			assertEquals(0, in.read());
+			assertEquals(7, in.getBitPosition());
+			assertEquals(1, in.read());
+			
+			// Read bits of 1st byte
+			assertEquals(0, in.getBitPosition());
+			assertEquals(1, in.read());
+			assertEquals(1, in.getBitPosition());
+			assertEquals(0, in.read());
+			assertEquals(2, in.getBitPosition());
+			assertEquals(1, in.read());
+			assertEquals(0, in.read());
+			assertEquals(0, in.read());
+			assertEquals(5, in.getBitPosition());
+			
+			// Read 2nd byte
+			assertEquals(0xBD, in.readByte());
+			
+			// Read bits of 3rd byte
+			assertEquals(0, in.getBitPosition());
+			assertEquals(0, in.read());
+			assertEquals(1, in.read());
+			assertEquals(0, in.read());
+			assertEquals(1, in.read());
+			assertEquals(1, in.read());
+			assertEquals(0, in.read());
+			assertEquals(6, in.getBitPosition());
+			assertEquals(1, in.read());
+			assertEquals(7, in.getBitPosition());
+			assertEquals(1, in.read());
+			
+			// Read 4th byte
+			assertEquals(0x5B, in.readByte());
+			
+			// Read bits of 5th byte
+			assertEquals(0, in.getBitPosition());
+			assertEquals(0, in.read());
+			assertEquals(1, in.getBitPosition());
+			
+			// Read 6th byte
+			assertEquals(0x3A, in.readByte());
+			
+			// Read bits of 7th byte
+			assertEquals(0, in.getBitPosition());
+			assertEquals(1, in.read());
+			assertEquals(0, in.read());
+			assertEquals(2, in.getBitPosition());
+			
+			// Read 8th byte
+			assertEquals(0x19, in.readByte());
+			
+			// Read bits of 9th byte
+			assertEquals(0, in.getBitPosition());
+			assertEquals(0, in.read());
+			assertEquals(1, in.read());
+			assertEquals(0, in.read());
+			assertEquals(1, in.read());
+			assertEquals(1, in.read());
+			assertEquals(1, in.read());
+			assertEquals(0, in.read());
+			assertEquals(7, in.getBitPosition());
+			
+			// Read 10th and 11th bytes
+			assertEquals(0x41, in.readByte());
+			assertEquals(0xA6, in.readByte());
+			assertEquals(0, in.getBitPosition());
+			assertEquals(-1, in.readByte());
+			assertEquals(-1, in.read());
+		}
+	}
+	
+	
+	@Test public void testPeekAndReadBits() throws IOException {
+		BufferedBitInputStream in = new BufferedBitInputStream(new ByteArrayInputStream(new byte[] {
+			(byte)0xB7, (byte)0xC5, (byte)0xBD, (byte)0xDA, (byte)0x5B,
+		}), 2);
+		assertEquals(0x7, in.peekBits(4));
+		assertEquals(0x5B7, in.peekBits(12));
+		in.consumeBits(3);
+		assertEquals(3, in.getBitPosition());
+		assertEquals(0xC5B7 >>> 3, in.readBits(13));
+		assertEquals(0, in.getBitPosition());
+		assertEquals(0xDABD, in.readBits(16));
+		assertEquals(0x5B, in.peekBits(32));  // Zero-padded past the end
+		try {
+			in.consumeBits(9);
+			fail();
+		} catch (EOFException e) {}  // Pass
+		assertEquals(0x5B, in.readBits(8));
+		assertEquals(-1, in.read());
+	}
+	
+	
+	@Test public void testRandomly() throws IOException {
+		for (int i = 0; i < 1000; i++) {
+			byte[] data = new byte[rand.nextInt(100)];
+			rand.nextBytes(data);
+			BitInputStream ref = new ByteBitInputStream(new ByteArrayInputStream(data));
+			BufferedBitInputStream in = new BufferedBitInputStream(new ByteArrayInputStream(data), rand.nextInt(20) + 1);
+			int bitsLeft = data.length * 8;
+			while (bitsLeft > 0) {
+				assertEquals(ref.getBitPosition(), in.getBitPosition());
+				int op = rand.nextInt(5);
+				if (op == 0) {
+					assertEquals(ref.read(), in.read());
+					bitsLeft--;
+				} else if (op == 1 && bitsLeft >= (8 - ref.getBitPosition()) % 8 + 8) {
+					bitsLeft -= (8 - ref.getBitPosition()) % 8 + 8;
+					assertEquals(ref.readByte(), in.readByte());
+				} else if (op == 4) {
+					byte[] b = new byte[rand.nextInt(60) + 2];
+					int skip = (8 - ref.getBitPosition()) % 8;
+					int n = in.readBytes(b, 1, b.length - 2);
+					assertEquals(Math.min(b.length - 2, (bitsLeft - skip) / 8), n);
+					for (int j = 0; j < n; j++)
+						assertEquals(ref.readByte(), b[1 + j] & 0xFF);
+					bitsLeft -= skip + n * 8;
+					if (n == 0) {  // Keep the reference in step by discarding the remainder of its byte
+						for (int j = 0; j < skip; j++)
+							ref.read();
+					}
+				} else {
+					int n = Math.min(rand.nextInt(33), bitsLeft);
+					int expect = 0;
+					for (int j = 0; j < n; j++)
+						expect |= ref.read() << j;
+					if (op == 2)
+						assertEquals(expect, in.readBits(n));
+					else {
+						assertEquals(expect, in.peekBits(n));
+						in.consumeBits(n);
+					}
+					bitsLeft -= n;
+				}
+			}
+			assertEquals(-1, in.read());
+		}
+	}
+	
+	
+	private static Random rand = new Random();
+	
+}
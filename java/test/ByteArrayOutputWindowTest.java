@@ -0,0 +1,58 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.util.Random;
+import org.junit.Assert;
+import org.junit.Test;
+
+
+public final class ByteArrayOutputWindowTest {
+	
+	@Test public void testCopyBeforeStart() {
+		ByteArrayOutputWindow w = new ByteArrayOutputWindow();
+		w.append(5);
+		w.copy(3, 4);
+		Assert.assertArrayEquals(new byte[]{5, 0, 0, 5, 0}, w.toByteArray());
+	}
+	
+	
+	@Test public void testRandomly() {
+		for (int i = 0; i < 300; i++) {
+			// Perform random operations on both the window and a naive buffer
+			ByteArrayOutputWindow w = new ByteArrayOutputWindow();
+			byte[] buf = new byte[rand.nextInt(100000)];
+			int index = 0;
+			while (index < buf.length) {
+				int op = rand.nextInt(3);
+				if (op == 0) {
+					byte b = (byte)rand.nextInt(256);
+					buf[index] = b;
+					index++;
+					w.append(b);
+				} else if (op == 1) {
+					byte[] b = new byte[Math.min(rand.nextInt(50), buf.length - index)];
+					rand.nextBytes(b);
+					System.arraycopy(b, 0, buf, index, b.length);
+					index += b.length;
+					w.append(b, 0, b.length);
+				} else {
+					int dist = rand.nextInt(Math.min(index, 32767) + 1) + 1;
+					int len = Math.min(rand.nextInt(259), buf.length - index);
+					for (int j = 0; j < len; j++, index++)
+						buf[index] = index - dist >= 0 ? buf[index - dist] : 0;
+					w.copy(dist, len);
+				}
+			}
+			Assert.assertArrayEquals(buf, w.toByteArray());
+		}
+	}
+	
+	
+	private static Random rand = new Random();
+	
+}
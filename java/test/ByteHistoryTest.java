@@ -8,7 +8,9 @@
 
 import java.io.ByteArrayOutputStream;
 import java.io.IOException;
+import java.util.Arrays;
 import java.util.Random;
+import java.util.zip.CRC32;
 import org.junit.Assert;
 import org.junit.Test;
 
@@ -37,6 +39,77 @@ public final class ByteHistoryTest {
 	}
 	
 	
+	@Test public void testReset() {
+		ByteHistory d = new ByteHistory(3);
+		d.append(5);
+		d.reset();
+		checkCopy(d, 3, 0, 0, 0);
+		d.append(1);
+		d.append(2);
+		checkCopy(d, 2, 1, 2, 1, 2);  // Wraps around
+		d.reset();
+		checkCopy(d, 3, 0, 0, 0);
+	}
+	
+	
+	@Test public void testBulkAppend() {
+		for (int i = 0; i < 1000; i++) {
+			int size = rand.nextInt(50) + 1;
+			ByteHistory bulk = new ByteHistory(size);
+			ByteHistory single = new ByteHistory(size);
+			for (int j = 0; j < 10; j++) {
+				byte[] b = new byte[rand.nextInt(size * 2 + 3)];
+				rand.nextBytes(b);
+				int off = b.length > 0 ? rand.nextInt(b.length) : 0;
+				int len = rand.nextInt(b.length - off + 1);
+				bulk.append(b, off, len);
+				for (int k = 0; k < len; k++)
+					single.append(b[off + k]);
+				Assert.assertArrayEquals(single.toByteArray(), bulk.toByteArray());
+			}
+		}
+	}
+	
+	
+	@Test public void testUpdateChecksum() {
+		for (int i = 0; i < 1000; i++) {
+			int size = rand.nextInt(50) + 1;
+			ByteHistory d = new ByteHistory(size);
+			byte[] b = new byte[rand.nextInt(size * 3)];
+			rand.nextBytes(b);
+			d.append(b, 0, b.length);
+			d.copy(rand.nextInt(size) + 1, rand.nextInt(size * 2));  // Without output
+			
+			// The most recent bytes, wrapping around the buffer or not, match the history's contents
+			byte[] all = d.toByteArray();
+			int len = rand.nextInt(size + 1);
+			CRC32 expect = new CRC32();
+			expect.update(all, all.length - len, len);
+			CRC32 actual = new CRC32();
+			d.updateChecksum(actual, len);
+			Assert.assertEquals(expect.getValue(), actual.getValue());
+		}
+	}
+	
+	
+	@Test public void testWrite() throws IOException {
+		for (int i = 0; i < 1000; i++) {
+			int size = rand.nextInt(50) + 1;
+			ByteHistory d = new ByteHistory(size);
+			byte[] b = new byte[rand.nextInt(size * 3)];
+			rand.nextBytes(b);
+			d.append(b, 0, b.length);
+			d.copy(rand.nextInt(size) + 1, rand.nextInt(size * 2));
+			
+			byte[] all = d.toByteArray();
+			int len = rand.nextInt(size + 1);
+			ByteArrayOutputStream bout = new ByteArrayOutputStream();
+			d.write(bout, len);
+			Assert.assertArrayEquals(Arrays.copyOfRange(all, all.length - len, all.length), bout.toByteArray());
+		}
+	}
+	
+	
 	@Test public void testRandomly() {
 		for (int i = 0; i < 3000; i++) {
 			// Initialize randomly sized circular dictionary and a naive buffer
@@ -0,0 +1,149 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.io.IOException;
+import java.util.ArrayList;
+import java.util.Collections;
+import java.util.List;
+import java.util.Random;
+import org.junit.Assert;
+import org.junit.Test;
+
+
+public final class CanonicalCodeTest {
+	
+	@Test public void testSmall() throws IOException {
+		// Codes: A=0, C=110, D=10, E=111
+		CanonicalCode code = new CanonicalCode(new int[]{1, 0, 3, 2, 3});
+		BitInputStream in = new StringBitInputStream("0" + "110" + "10" + "111" + "0" + "10");
+		Assert.assertEquals(0, code.decodeNextSymbol(in));
+		Assert.assertEquals(2, code.decodeNextSymbol(in));
+		Assert.assertEquals(3, code.decodeNextSymbol(in));
+		Assert.assertEquals(4, code.decodeNextSymbol(in));
+		Assert.assertEquals(0, code.decodeNextSymbol(in));
+		Assert.assertEquals(3, code.decodeNextSymbol(in));
+	}
+	
+	
+	@Test public void testInvalidCodes() {
+		int[][] cases = {
+			{0, 2, 0},
+			{0, 1, 0, 2},
+			{1, 1, 1},
+			{1, 1, 2, 2, 3, 3, 3, 3},
+			{0, 0, 0},
+			{1, 16},
+			{1, -1},
+		};
+		for (int[] codeLens : cases) {
+			try {
+				new CanonicalCode(codeLens);
+				Assert.fail();
+			} catch (IllegalArgumentException e) {}  // Pass
+		}
+	}
+	
+	
+	@Test public void testRandomly() throws IOException {
+		for (int i = 0; i < 1000; i++) {
+			// Make a random full code tree, possibly with codes longer than the primary table
+			int numSymbols = rand.nextInt(i % 2 == 0 ? 30 : 287) + 2;
+			List<Integer> codeLenList = new ArrayList<>();
+			codeLenList.add(0);
+			while (codeLenList.size() < numSymbols) {
+				int j = rand.nextInt(codeLenList.size());
+				int depth = codeLenList.get(j);
+				if (depth < 15) {
+					codeLenList.set(j, depth + 1);
+					codeLenList.add(depth + 1);
+				}
+			}
+			for (int j = rand.nextInt(10); j > 0; j--)
+				codeLenList.add(0);  // Unused symbols
+			Collections.shuffle(codeLenList, rand);
+			int[] codeLens = new int[codeLenList.size()];
+			for (int j = 0; j < codeLens.length; j++)
+				codeLens[j] = codeLenList.get(j);
+			
+			// Encode a random sequence of symbols and decode it back
+			String[] codeStrings = makeCodeStrings(codeLens);
+			int[] symbols = new int[100];
+			StringBuilder sb = new StringBuilder();
+			for (int j = 0; j < symbols.length; j++) {
+				do symbols[j] = rand.nextInt(codeLens.length);
+				while (codeLens[symbols[j]] == 0);
+				sb.append(codeStrings[symbols[j]]);
+			}
+			CanonicalCode code = new CanonicalCode(codeLens);
+			BitInputStream in = new StringBitInputStream(sb.toString());
+			for (int sym : symbols)
+				Assert.assertEquals(sym, code.decodeNextSymbol(in));
+		}
+	}
+	
+	
+	@Test public void testLiteralPairs() {
+		for (int i = 0; i < 300; i++) {
+			// Make a random full code tree over a literal/length alphabet, with mostly short codes
+			List<Integer> codeLenList = new ArrayList<>();
+			codeLenList.add(0);
+			int numSymbols = rand.nextInt(250) + 2;
+			while (codeLenList.size() < numSymbols) {
+				int j = rand.nextInt(codeLenList.size());
+				int depth = codeLenList.get(j);
+				if (depth < 15) {
+					codeLenList.set(j, depth + 1);
+					codeLenList.add(depth + 1);
+				}
+			}
+			while (codeLenList.size() < 286)
+				codeLenList.add(0);
+			Collections.shuffle(codeLenList, rand);
+			int[] codeLens = new int[codeLenList.size()];
+			int maxLen = 0;
+			for (int j = 0; j < codeLens.length; j++) {
+				codeLens[j] = codeLenList.get(j);
+				maxLen = Math.max(codeLens[j], maxLen);
+			}
+			
+			// Every pair entry must agree with two single lookups
+			CanonicalCode code = new CanonicalCode(codeLens);
+			int primaryBits = Math.min(maxLen, 10);
+			for (int j = 0; j < 1000; j++) {
+				int bits = rand.nextInt(1 << 15);
+				int first = code.lookup(bits);
+				int second = code.lookup(bits >>> (first & 0xF));
+				int expect = 0;
+				if (first >>> 4 < 256 && second >>> 4 < 256 && (first & 0xF) + (second & 0xF) <= primaryBits)
+					expect = (second >>> 4) << 16 | (first >>> 4) << 8 | ((first & 0xF) + (second & 0xF));
+				Assert.assertEquals(expect, code.lookupLiteralPair(bits));
+			}
+		}
+	}
+	
+	
+	// Returns the canonical code of each symbol as a string of 0s and 1s, in the order the bits appear in a stream.
+	private static String[] makeCodeStrings(int[] codeLens) {
+		String[] result = new String[codeLens.length];
+		int nextCode = 0;
+		for (int codeLen = 1; codeLen <= 15; codeLen++) {
+			nextCode <<= 1;
+			for (int sym = 0; sym < codeLens.length; sym++) {
+				if (codeLens[sym] == codeLen) {
+					result[sym] = Integer.toBinaryString(1 << codeLen | nextCode).substring(1);
+					nextCode++;
+				}
+			}
+		}
+		return result;
+	}
+	
+	
+	private static Random rand = new Random();
+	
+}
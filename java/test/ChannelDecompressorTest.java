@@ -0,0 +1,192 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
+import java.io.File;
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.nio.ReadOnlyBufferException;
+import java.nio.channels.AsynchronousFileChannel;
+import java.nio.channels.Channels;
+import java.nio.channels.CompletionHandler;
+import java.nio.channels.ReadableByteChannel;
+import java.nio.file.Files;
+import java.nio.file.StandardOpenOption;
+import java.util.Arrays;
+import java.util.Random;
+import java.util.concurrent.ArrayBlockingQueue;
+import java.util.concurrent.BlockingQueue;
+import java.util.zip.DataFormatException;
+import java.util.zip.Deflater;
+import org.junit.Assert;
+import org.junit.Test;
+
+
+public final class ChannelDecompressorTest {
+	
+	@Test public void testRandomBuffers() throws IOException, DataFormatException {
+		ChannelDecompressor decomp = new ChannelDecompressor();
+		for (int i = 0; i < 100; i++) {
+			byte[] data = randomData(rand.nextInt(100000));
+			byte[] comp = compress(data, rand.nextInt(10));
+			decomp.reset();
+			
+			// Feed pieces of random sizes in assorted kinds of buffers, and take the output in small
+			// buffers so that decoding is often stopped by a full buffer and then resumed
+			ByteArrayOutputStream bout = new ByteArrayOutputStream();
+			int inPos = 0;
+			while (!decomp.isFinished()) {
+				if (decomp.needsInput()) {
+					Assert.assertTrue(inPos < comp.length);
+					int n = Math.min(rand.nextInt(1000) + 1, comp.length - inPos);
+					ByteBuffer in = randomBuffer(n);
+					in.put(comp, inPos, n).flip();
+					if (rand.nextBoolean())
+						in = in.asReadOnlyBuffer();
+					decomp.feed(in);
+					Assert.assertFalse(in.hasRemaining());
+					inPos += n;
+				}
+				ByteBuffer out = randomBuffer(rand.nextInt(300));
+				int n = decomp.decompress(out);
+				Assert.assertEquals(n == -1 ? 0 : n, out.position());
+				out.flip();
+				byte[] b = new byte[out.remaining()];
+				out.get(b);
+				bout.write(b);
+			}
+			Assert.assertArrayEquals(data, bout.toByteArray());
+			Assert.assertEquals(-1, decomp.decompress(ByteBuffer.allocate(10)));
+		}
+	}
+	
+	
+	@Test public void testReadableChannel() throws IOException, DataFormatException {
+		for (int i = 0; i < 30; i++) {
+			byte[] data = randomData(rand.nextInt(30000));
+			byte[] comp = compress(data, rand.nextInt(10));
+			byte[] input = Arrays.copyOf(comp, comp.length + 3);  // With a trailer
+			ReadableByteChannel ch = Channels.newChannel(new ByteArrayInputStream(input));
+			
+			ChannelDecompressor decomp = new ChannelDecompressor();
+			ByteArrayOutputStream bout = new ByteArrayOutputStream();
+			while (true) {
+				if (decomp.needsInput())
+					Assert.assertTrue(decomp.readFrom(ch) >= 0);
+				ByteBuffer slice = decomp.decompressSlice();
+				if (slice == null)
+					break;
+				Assert.assertTrue(slice.isReadOnly());
+				byte[] b = new byte[slice.remaining()];
+				slice.get(b);
+				bout.write(b);
+			}
+			Assert.assertArrayEquals(data, bout.toByteArray());
+			while (decomp.readFrom(ch) != -1);  // The trailer might not have been read yet
+			Assert.assertEquals(3, decomp.getRemaining());
+		}
+	}
+	
+	
+	@Test public void testAsynchronousFileChannel() throws Exception {
+		byte[] data = randomData(300000);
+		byte[] comp = compress(data, 6);
+		File file = File.createTempFile("ChannelDecompressorTest", ".deflate");
+		try {
+			Files.write(file.toPath(), comp);
+			try (AsynchronousFileChannel ch = AsynchronousFileChannel.open(file.toPath(), StandardOpenOption.READ)) {
+				final BlockingQueue<Object> results = new ArrayBlockingQueue<>(1);
+				CompletionHandler<Integer,Void> handler = new CompletionHandler<Integer,Void>() {
+					public void completed(Integer result, Void att) {
+						results.add(result);
+					}
+					public void failed(Throwable exc, Void att) {
+						results.add(exc);
+					}
+				};
+				
+				ChannelDecompressor decomp = new ChannelDecompressor();
+				ByteArrayOutputStream bout = new ByteArrayOutputStream();
+				ByteBuffer out = ByteBuffer.allocateDirect(5000);
+				long pos = 0;
+				while (!decomp.isFinished()) {
+					if (decomp.needsInput()) {
+						decomp.readFrom(ch, pos, null, handler);
+						Object result = results.take();
+						Assert.assertTrue(result instanceof Integer && (Integer)result > 0);
+						pos += (Integer)result;
+					}
+					out.clear();
+					decomp.decompress(out);
+					out.flip();
+					byte[] b = new byte[out.remaining()];
+					out.get(b);
+					bout.write(b);
+				}
+				Assert.assertArrayEquals(data, bout.toByteArray());
+			}
+		} finally {
+			file.delete();
+		}
+	}
+	
+	
+	@Test public void testReadOnlyOutput() throws IOException, DataFormatException {
+		ChannelDecompressor decomp = new ChannelDecompressor();
+		decomp.feed(ByteBuffer.wrap(compress(new byte[10], 6)));
+		try {
+			decomp.decompress(ByteBuffer.allocate(10).asReadOnlyBuffer());
+			Assert.fail();
+		} catch (ReadOnlyBufferException e) {}  // Pass
+		Assert.assertEquals(10, decomp.decompress(ByteBuffer.allocate(20)));
+	}
+	
+	
+	// Returns a heap buffer (possibly a slice at a nonzero array offset) or a direct buffer, of the given capacity.
+	private static ByteBuffer randomBuffer(int capacity) {
+		switch (rand.nextInt(3)) {
+			case 0:
+				return ByteBuffer.allocate(capacity);
+			case 1:
+				ByteBuffer b = ByteBuffer.allocate(capacity + 7);
+				b.position(7);
+				return b.slice();
+			default:
+				return ByteBuffer.allocateDirect(capacity);
+		}
+	}
+	
+	
+	// Returns compressible random bytes.
+	private static byte[] randomData(int len) {
+		byte[] result = new byte[len];
+		int alphabet = rand.nextInt(256) + 1;
+		for (int i = 0; i < len; i++)
+			result[i] = (byte)rand.nextInt(alphabet);
+		return result;
+	}
+	
+	
+	// Returns the raw DEFLATE compression of the given data at the given level.
+	private static byte[] compress(byte[] data, int level) {
+		Deflater def = new Deflater(level, true);
+		def.setInput(data);
+		def.finish();
+		ByteArrayOutputStream bout = new ByteArrayOutputStream();
+		byte[] buf = new byte[4096];
+		while (!def.finished())
+			bout.write(buf, 0, def.deflate(buf));
+		def.end();
+		return bout.toByteArray();
+	}
+	
+	
+	private static Random rand = new Random();
+	
+}
@@ -0,0 +1,99 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.util.Random;
+import java.util.zip.CRC32;
+import org.junit.Assert;
+import org.junit.Test;
+
+
+public final class ChecksumOutputWindowTest {
+	
+	@Test public void testCopyBeforeStart() throws IOException {
+		ChecksumOutputWindow w = new ChecksumOutputWindow();
+		w.append(5);
+		w.copy(3, 4);
+		checkWindow(new byte[]{5, 0, 0, 5, 0}, w);
+	}
+	
+	
+	@Test public void testRandomly() throws IOException {
+		ChecksumOutputWindow w = new ChecksumOutputWindow();
+		for (int i = 0; i < 300; i++) {
+			w.reset();
+			byte[] buf = new byte[rand.nextInt(200000)];
+			applyRandomOperations(w, buf);
+			checkWindow(buf, w);
+		}
+	}
+	
+	
+	@Test public void testOutputStream() throws IOException {
+		for (int i = 0; i < 100; i++) {
+			ByteArrayOutputStream bout = new ByteArrayOutputStream();
+			ChecksumOutputWindow w = new ChecksumOutputWindow(bout);
+			byte[] buf = new byte[rand.nextInt(200000)];
+			applyRandomOperations(w, buf);
+			checkWindow(buf, w);  // Writes the rest of the output
+			Assert.assertArrayEquals(buf, bout.toByteArray());
+		}
+	}
+	
+	
+	// Fills the given naive buffer by random operations, performing each on the window too.
+	private static void applyRandomOperations(ChecksumOutputWindow w, byte[] buf) throws IOException {
+		int index = 0;
+		while (index < buf.length) {
+			int op = rand.nextInt(4);
+			if (op == 0) {
+				byte b = (byte)rand.nextInt(256);
+				buf[index] = b;
+				index++;
+				w.append(b);
+			} else if (op == 1) {
+				byte[] b = new byte[Math.min(rand.nextInt(50), buf.length - index)];
+				rand.nextBytes(b);
+				System.arraycopy(b, 0, buf, index, b.length);
+				index += b.length;
+				w.append(b, 0, b.length);
+			} else if (op == 2) {
+				// Bulk read, sometimes longer than the history and sometimes running out of input
+				byte[] b = new byte[Math.min(rand.nextInt(rand.nextBoolean() ? 100 : 70000), buf.length - index)];
+				rand.nextBytes(b);
+				int len = b.length + (rand.nextInt(10) == 0 ? 5 : 0);
+				int n = w.appendFrom(new ByteBufferBitInputStream(ByteBuffer.wrap(b)), len);
+				Assert.assertEquals(b.length, n);
+				System.arraycopy(b, 0, buf, index, b.length);
+				index += b.length;
+			} else {
+				// Copy, sometimes longer than the history
+				int dist = rand.nextInt(Math.min(index, 32767) + 1) + 1;
+				int len = Math.min(rand.nextInt(rand.nextBoolean() ? 259 : 100000), buf.length - index);
+				for (int j = 0; j < len; j++, index++)
+					buf[index] = index - dist >= 0 ? buf[index - dist] : 0;
+				w.copy(dist, len);
+			}
+		}
+	}
+	
+	
+	// Asserts that the window's length and CRC match the given data.
+	private static void checkWindow(byte[] expect, ChecksumOutputWindow w) throws IOException {
+		CRC32 crc = new CRC32();
+		crc.update(expect, 0, expect.length);
+		Assert.assertEquals(expect.length, w.getLength());
+		Assert.assertEquals(crc.getValue(), w.getCrc().getValue());
+	}
+	
+	
+	private static Random rand = new Random();
+	
+}
@@ -0,0 +1,124 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.util.Random;
+import java.util.zip.DataFormatException;
+import java.util.zip.Deflater;
+import org.junit.Assert;
+import org.junit.Test;
+
+
+public final class DecompressionLimitsTest {
+	
+	@Test public void testWithinLimits() throws IOException, DataFormatException {
+		for (int i = 0; i < 30; i++) {
+			byte[] data = new byte[rand.nextInt(300000)];
+			int alphabet = rand.nextInt(256) + 1;
+			for (int j = 0; j < data.length; j++)
+				data[j] = (byte)rand.nextInt(alphabet);
+			byte[] comp = compress(data, rand.nextInt(10));
+			
+			// Exactly the output length is allowed
+			DecompressionLimits limits = new DecompressionLimits(data.length, 1.0);
+			Assert.assertArrayEquals(data, Decompressor.decompress(new ByteBufferBitInputStream(ByteBuffer.wrap(comp)), limits));
+			ByteArrayOutputStream out = new ByteArrayOutputStream();
+			Decompressor.decompress(new BufferedBitInputStream(new ByteArrayInputStream(comp)), out, new DecompressionLimits(data.length, 1000));
+			Assert.assertArrayEquals(data, out.toByteArray());
+		}
+	}
+	
+	
+	@Test public void testOutputLimit() throws IOException, DataFormatException {
+		byte[] comp = compress(new byte[100000], 6);
+		try {
+			Decompressor.decompress(new ByteBufferBitInputStream(ByteBuffer.wrap(comp)), new DecompressionLimits(99999, Double.POSITIVE_INFINITY));
+			Assert.fail();
+		} catch (DecompressionLimitException e) {}  // Pass
+		
+		// Stored blocks are checked too, through a stream without bulk reads
+		comp = compress(randomBytes(100000), 0);
+		try {
+			Decompressor.decompress(new StringBitInputStream(toBitString(comp)), new DecompressionLimits(50000, Double.POSITIVE_INFINITY));
+			Assert.fail();
+		} catch (DecompressionLimitException e) {}  // Pass
+	}
+	
+	
+	@Test public void testRatioLimit() throws IOException, DataFormatException {
+		// About 10 KB of input expands to 10 MB, a ratio of about 1000
+		byte[] comp = compress(new byte[10000000], 9);
+		try {
+			Decompressor.decompress(new ByteBufferBitInputStream(ByteBuffer.wrap(comp)), new DecompressionLimits(Long.MAX_VALUE, 100));
+			Assert.fail();
+		} catch (DecompressionLimitException e) {}  // Pass
+		
+		// Highly compressible output up to the grace amount is allowed
+		comp = compress(new byte[(int)DecompressionLimits.RATIO_GRACE_BYTES], 9);
+		Assert.assertEquals(DecompressionLimits.RATIO_GRACE_BYTES, Decompressor.decompress(new ByteBufferBitInputStream(ByteBuffer.wrap(comp)), new DecompressionLimits(Long.MAX_VALUE, 1)).length);
+	}
+	
+	
+	@Test public void testStoredBlocksWithinRatio() throws IOException, DataFormatException {
+		// Stored blocks never expand, so a ratio of 1 must allow them beyond the grace amount
+		byte[] data = randomBytes(3000000);
+		byte[] comp = compress(data, 0);
+		Assert.assertArrayEquals(data, Decompressor.decompress(new ByteBufferBitInputStream(ByteBuffer.wrap(comp)), new DecompressionLimits(Long.MAX_VALUE, 1)));
+	}
+	
+	
+	@Test(expected=IllegalArgumentException.class)
+	public void testNegativeOutputLimit() {
+		new DecompressionLimits(-1, 10);
+	}
+	
+	
+	@Test(expected=IllegalArgumentException.class)
+	public void testNanRatio() {
+		new DecompressionLimits(100, Double.NaN);
+	}
+	
+	
+	private static byte[] randomBytes(int len) {
+		byte[] result = new byte[len];
+		rand.nextBytes(result);
+		return result;
+	}
+	
+	
+	// Returns the bits of the given bytes as a string of '0' and '1', each byte from its least significant bit.
+	private static String toBitString(byte[] b) {
+		StringBuilder sb = new StringBuilder();
+		for (byte x : b) {
+			for (int i = 0; i < 8; i++)
+				sb.append((x >>> i) & 1);
+		}
+		return sb.toString();
+	}
+	
+	
+	// Returns the raw DEFLATE compression of the given data at the given level.
+	private static byte[] compress(byte[] data, int level) {
+		Deflater def = new Deflater(level, true);
+		def.setInput(data);
+		def.finish();
+		ByteArrayOutputStream bout = new ByteArrayOutputStream();
+		byte[] buf = new byte[4096];
+		while (!def.finished())
+			bout.write(buf, 0, def.deflate(buf));
+		def.end();
+		return bout.toByteArray();
+	}
+	
+	
+	private static Random rand = new Random();
+	
+}
@@ -0,0 +1,87 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.util.Random;
+import java.util.zip.DataFormatException;
+import java.util.zip.Deflater;
+import org.junit.Assert;
+import org.junit.Test;
+
+
+public final class DecompressorListenerTest {
+	
+	@Test public void testTotals() throws IOException, DataFormatException {
+		for (int i = 0; i < 100; i++) {
+			byte[] data = new byte[rand.nextInt(200000)];
+			for (int j = 0; j < data.length; j++) {
+				if (j >= 100 && rand.nextInt(4) == 0)
+					data[j] = data[j - rand.nextInt(100) - 1];
+				else
+					data[j] = (byte)('a' + rand.nextInt(rand.nextInt(26) + 1));
+			}
+			byte[] comp = compress(data, rand.nextInt(10));
+			
+			final long[] totals = new long[3];  // Blocks, compressed bits, uncompressed bytes
+			DecompressorListener listener = new DecompressorListener() {
+				public void blockDecoded(BlockStatistics stats) {
+					Assert.assertTrue(stats.blockType >= 0 && stats.blockType <= 2);
+					long matched = 0;
+					long matches = 0;
+					for (int len = 0; len < stats.matchLengthHistogram.length; len++) {
+						matched += stats.matchLengthHistogram[len] * len;
+						matches += stats.matchLengthHistogram[len];
+					}
+					long distances = 0;
+					for (long n : stats.distanceSymbolHistogram)
+						distances += n;
+					Assert.assertEquals(stats.matchCount, matches);
+					Assert.assertEquals(stats.matchCount, distances);
+					if (stats.blockType != 0)
+						Assert.assertEquals(stats.uncompressedBytes, stats.literalCount + matched);
+					if (stats.blockType != 2)
+						Assert.assertEquals(0, stats.headerBits);
+					Assert.assertTrue(stats.headerBits < stats.compressedBits);
+					Assert.assertTrue(stats.headerNanos >= 0 && stats.bodyNanos >= 0);
+					totals[0]++;
+					totals[1] += stats.compressedBits;
+					totals[2] += stats.uncompressedBytes;
+				}
+			};
+			
+			ByteArrayOutputStream out = new ByteArrayOutputStream();
+			BitInputStream in = rand.nextBoolean() ? new ByteBitInputStream(new ByteArrayInputStream(comp))
+				: new BufferedBitInputStream(new ByteArrayInputStream(comp));
+			Decompressor.decompress(in, out, listener);
+			Assert.assertArrayEquals(data, out.toByteArray());
+			Assert.assertTrue(totals[0] >= 1);
+			Assert.assertTrue(totals[1] > (comp.length - 1) * 8L && totals[1] <= comp.length * 8L);
+			Assert.assertEquals(data.length, totals[2]);
+		}
+	}
+	
+	
+	// Returns the raw DEFLATE compression of the given data at the given level.
+	private static byte[] compress(byte[] data, int level) {
+		Deflater def = new Deflater(level, true);
+		def.setInput(data);
+		def.finish();
+		ByteArrayOutputStream bout = new ByteArrayOutputStream();
+		byte[] buf = new byte[4096];
+		while (!def.finished())
+			bout.write(buf, 0, def.deflate(buf));
+		def.end();
+		return bout.toByteArray();
+	}
+	
+	
+	private static Random rand = new Random();
+	
+}
@@ -0,0 +1,84 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.io.ByteArrayOutputStream;
+import java.io.EOFException;
+import java.io.IOException;
+import java.util.Arrays;
+import java.util.Random;
+import java.util.zip.DataFormatException;
+import java.util.zip.Deflater;
+import org.junit.Assert;
+import org.junit.Test;
+
+
+public final class DecompressorPoolTest {
+	
+	@Test public void testRandomly() throws IOException, DataFormatException {
+		DecompressorPool pool = new DecompressorPool(1);
+		for (int i = 0; i < 1000; i++) {
+			byte[] data = new byte[rand.nextInt(3000)];
+			for (int j = 0; j < data.length; j++)
+				data[j] = (byte)('a' + rand.nextInt(rand.nextInt(26) + 1));
+			byte[] comp = compress(data, rand.nextInt(10));
+			byte[] src = Arrays.copyOf(comp, comp.length + rand.nextInt(3));  // Possibly with trailing bytes
+			
+			// Output buffers that are too small, exactly right, or larger
+			int dstLen = Math.max(data.length + rand.nextInt(5) - 2, 0);
+			byte[] dst = new byte[dstLen + 1];
+			dst[dst.length - 1] = 17;
+			try {
+				int n = pool.decompress(src, 0, src.length, dst, 0, dstLen);
+				Assert.assertTrue(dstLen >= data.length);
+				Assert.assertEquals(data.length, n);
+				Assert.assertArrayEquals(data, Arrays.copyOf(dst, n));
+			} catch (DataFormatException e) {
+				Assert.assertTrue(dstLen < data.length);
+			}
+			Assert.assertEquals(17, dst[dst.length - 1]);  // Must not write past the range
+			
+			// Truncated input
+			if (comp.length > 1) {
+				try {
+					pool.decompress(comp, 0, rand.nextInt(comp.length - 1), new byte[data.length], 0, data.length);
+					Assert.fail();
+				} catch (EOFException e) {}  // Pass
+			}
+		}
+	}
+	
+	
+	@Test public void testAcquireRelease() {
+		DecompressorPool pool = new DecompressorPool(1);
+		ResumableDecompressor a = pool.acquire();
+		ResumableDecompressor b = pool.acquire();
+		Assert.assertNotSame(a, b);
+		pool.release(a);
+		pool.release(b);  // Discarded because the pool is full
+		Assert.assertSame(a, pool.acquire());
+		Assert.assertTrue(pool.acquire().needsInput());
+	}
+	
+	
+	// Returns the raw DEFLATE compression of the given data at the given level.
+	private static byte[] compress(byte[] data, int level) {
+		Deflater def = new Deflater(level, true);
+		def.setInput(data);
+		def.finish();
+		ByteArrayOutputStream bout = new ByteArrayOutputStream();
+		byte[] buf = new byte[4096];
+		while (!def.finished())
+			bout.write(buf, 0, def.deflate(buf));
+		def.end();
+		return bout.toByteArray();
+	}
+	
+	
+	private static Random rand = new Random();
+	
+}
@@ -7,8 +7,14 @@
  */
 
 import static org.junit.Assert.assertArrayEquals;
+import static org.junit.Assert.assertEquals;
+import static org.junit.Assert.fail;
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
 import java.io.EOFException;
 import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.util.Arrays;
 import java.util.zip.DataFormatException;
 import org.junit.Test;
 
@@ -227,6 +233,24 @@ public final class DecompressorTest {
 	}
 	
 	
+	@Test
+	public void testDynamicHuffmanLiteralsNoDistanceCode() throws IOException, DataFormatException {
+		// Dynamic Huffman block:
+		//   numCodeLen=18
+		//     codeLenCodeLen = 0:2, 1:2, 2:0, ..., 15:0, 16:0, 17:0, 18:1
+		//   numLitLen=257, numDist=1
+		//     litLenCodeLen = 0:0, ..., 254:0, 255:1, 256:1
+		//     distCodeLen = 0:0
+		//   Data: #255 #255 #255 End
+		String blockHeader = "1 01";
+		String codeCounts = "00000 00000 0111";
+		String codeLenCodeLens = "000 000 100 010 000 000 000 000 000 000 000 000 000 000 000 000 000 010";
+		String codeLens = "01111111 00101011 11 11 10";
+		String data = "0 0 0 1";
+		test(blockHeader + codeCounts + codeLenCodeLens + codeLens + data, "FF FF FF");
+	}
+	
+	
 	@Test(expected=DataFormatException.class)
 	public void testDynamicHuffmanCodeLengthRepeatAtStart() throws IOException, DataFormatException {
 		// Dynamic Huffman block:
@@ -403,10 +427,128 @@ public final class DecompressorTest {
 		for (int i = 0; i < refBytes.length; i++)
 			refBytes[i] = (byte)Integer.parseInt(refOutput.substring(i * 2, (i + 1) * 2), 16);
 		
-		// Decompress and compare the data
-		BitInputStream in = new StringBitInputStream(input.replace(" ", ""));
-		byte[] actualOut = Decompressor.decompress(in);
-		assertArrayEquals(refBytes, actualOut);
-	}
+		// Pack the input bits into bytes for the peekable stream
+		input = input.replace(" ", "");
+		byte[] inputBytes = new byte[(input.length() + 7) / 8];
+		for (int i = 0; i < input.length(); i++)
+			inputBytes[i >>> 3] |= (input.charAt(i) - '0') << (i & 7);
+		
+		// Decompress in every supported way, which must all agree
+		// on the data or on the type of exception thrown
+		Exception firstException = null;
+		for (int way = 0; way < NUM_WAYS; way++) {
+			try {
+				byte[] actualOut = decompress(way, input, inputBytes);
+				if (firstException != null)
+					fail("Expected " + firstException.getClass().getSimpleName());
+				assertArrayEquals(refBytes, actualOut);
+			} catch (IOException|DataFormatException e) {
+				if (way == 0)
+					firstException = e;
+				else if (firstException == null || firstException.getClass() != e.getClass())
+					throw e;
+			}
+		}
+		
+		// Rethrow for tests that expect an exception
+		if (firstException instanceof IOException)
+			throw (IOException)firstException;
+		if (firstException instanceof DataFormatException)
+			throw (DataFormatException)firstException;
+	}
+	
+	
+	// Decompresses the given input (as a bit string and as packed bytes) in the given way.
+	private static byte[] decompress(int way, String bits, byte[] bytes) throws IOException, DataFormatException {
+		switch (way) {
+			case 0:  // Bit-at-a-time stream, with the output collected in an array window
+				return Decompressor.decompress(new StringBitInputStream(bits));
+			case 1:  // Peekable stream, with the output collected in an array window
+				return Decompressor.decompress(new BufferedBitInputStream(new ByteArrayInputStream(bytes)));
+			case 2: {  // Peekable stream, with the output written to a stream through a byte history
+				ByteArrayOutputStream out = new ByteArrayOutputStream();
+				Decompressor.decompress(new BufferedBitInputStream(new ByteArrayInputStream(bytes)), out);
+				return out.toByteArray();
+			}
+			case 3: {  // Direct byte buffer with surrounding data, whose position must end up after the DEFLATE data
+				ByteBuffer buf = ByteBuffer.allocateDirect(bytes.length + 4);
+				buf.put(new byte[3]).put(bytes).put((byte)0xA5);
+				buf.position(3);
+				buf.limit(3 + bytes.length);
+				byte[] result = Decompressor.decompress(buf);
+				assertEquals(3 + bytes.length, buf.position());
+				return result;
+			}
+			case 4:  // Resumable decompressor over a bit-at-a-time stream, with short output arrays
+				return decompressResumably(new StringBitInputStream(bits));
+			case 5:  // Resumable decompressor over a peekable stream, with short output arrays
+				return decompressResumably(new BufferedBitInputStream(new ByteArrayInputStream(bytes)));
+			case 6:  // Reused resumable decompressor with the input fed in short pieces
+				return decompressByFeeding(bytes);
+			case 7: {  // Pooled decompressor with the whole input at once
+				byte[] buf = new byte[70000];
+				int n = POOL.decompress(bytes, 0, bytes.length, buf, 1, buf.length - 2);
+				return Arrays.copyOfRange(buf, 1, 1 + n);
+			}
+			default:
+				throw new IllegalArgumentException();
+		}
+	}
+	
+	
+	// Decompresses the given input by repeatedly filling an array range whose length cycles through
+	// 0 to 12, so that literals, copies and uncompressed blocks get split at many different points.
+	private static byte[] decompressResumably(BitInputStream in) throws IOException, DataFormatException {
+		ResumableDecompressor decomp = new ResumableDecompressor(in);
+		ByteArrayOutputStream out = new ByteArrayOutputStream();
+		byte[] buf = new byte[16];
+		boolean wasShort = false;
+		for (int i = 0; ; i++) {
+			int len = i % 13;
+			int n = decomp.decompress(buf, 2, len);
+			if (n == -1)
+				break;
+			assertEquals(false, wasShort);  // Only the last piece before the end can be short
+			wasShort = n < len;
+			out.write(buf, 2, n);
+		}
+		assertEquals(true, decomp.isFinished());
+		assertEquals(-1, decomp.decompress(buf, 0, 1));
+		return out.toByteArray();
+	}
+	
+	
+	// Decompresses the given input by feeding it 1 to 4 bytes at a time whenever the decompressor
+	// runs out, so that block headers, symbols and extra bits get split at many different points.
+	// The same decompressor is reset and reused for every stream, even after an exception.
+	private static byte[] decompressByFeeding(byte[] bytes) throws IOException, DataFormatException {
+		ResumableDecompressor decomp = SHARED_DECOMPRESSOR;
+		decomp.reset();
+		ByteArrayOutputStream out = new ByteArrayOutputStream();
+		byte[] buf = new byte[7];
+		int index = 0;
+		for (int i = 0; ; i++) {
+			int n = decomp.decompress(buf, 0, buf.length);
+			if (n == -1)
+				break;
+			out.write(buf, 0, n);
+			if (decomp.needsInput()) {
+				if (index == bytes.length)
+					throw new EOFException();  // Truncated input never finishes
+				int len = Math.min(i % 4 + 1, bytes.length - index);
+				decomp.feed(bytes, index, len);
+				index += len;
+			}
+		}
+		assertEquals(true, decomp.isFinished());
+		return out.toByteArray();
+	}
+	
+	
+	private static final int NUM_WAYS = 8;
+	
+	private static final ResumableDecompressor SHARED_DECOMPRESSOR = new ResumableDecompressor();
+	
+	private static final DecompressorPool POOL = new DecompressorPool(2);
 	
 }
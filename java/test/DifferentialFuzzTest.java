@@ -0,0 +1,867 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
+import java.io.EOFException;
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.util.Arrays;
+import java.util.HashMap;
+import java.util.Map;
+import java.util.Random;
+import java.util.zip.Adler32;
+import java.util.zip.CRC32;
+import java.util.zip.DataFormatException;
+import java.util.zip.Deflater;
+import java.util.zip.Inflater;
+import org.junit.Assert;
+import org.junit.Test;
+
+
+/**
+ * Decodes valid, damaged, and random DEFLATE streams with an independent reference decoder and with every
+ * path of the real one, and fails on any difference in the output or in the type of exception thrown. The paths
+ * include the zlib and gzip containers around the stream and random access through a seek index. The output
+ * is also compared with java.util.zip.Inflater. When an input fails here, the message has its hexadecimal
+ * bytes, which should be added to the regression corpus at the end of this file. The message also has the
+ * random seed, which can be given back as the system property {@code fuzz.seed} to repeat the same run.
+ */
+public final class DifferentialFuzzTest {
+	
+	/*---- Test suite ----*/
+	
+	@Test public void testCorpus() throws IOException, DataFormatException {
+		for (String hex : CORPUS)
+			check(parseHex(hex), false);
+	}
+	
+	
+	@Test public void testValidStreams() throws IOException, DataFormatException {
+		for (int i = 0; i < 300; i++) {
+			byte[] data = randomData(rand.nextInt(i % 10 == 0 ? 300000 : 30000));
+			Assert.assertArrayEquals("Seed " + SEED, data, check(compressRandomly(data), true));
+		}
+	}
+	
+	
+	@Test public void testTruncatedStreams() throws IOException, DataFormatException {
+		for (int i = 0; i < 300; i++) {
+			byte[] comp = compressRandomly(randomData(rand.nextInt(10000)));
+			Assert.assertNull("Seed " + SEED, check(Arrays.copyOf(comp, rand.nextInt(comp.length)), true));
+		}
+	}
+	
+	
+	@Test public void testDamagedStreams() throws IOException, DataFormatException {
+		for (int i = 0; i < 1000; i++) {
+			byte[] comp = compressRandomly(randomData(rand.nextInt(10000)));
+			int numMutations = rand.nextInt(3) + 1;
+			for (int j = 0; j < numMutations; j++)
+				comp = mutate(comp);
+			check(comp, false);
+		}
+	}
+	
+	
+	@Test public void testRandomStreams() throws IOException, DataFormatException {
+		for (int i = 0; i < 3000; i++) {
+			// Random bits after a fixed or dynamic Huffman block header often decode for a while
+			byte[] b = new byte[rand.nextInt(1000) + 1];
+			rand.nextBytes(b);
+			if (rand.nextInt(4) != 0)
+				b[0] = (byte)(b[0] & ~7 | (rand.nextBoolean() ? 3 : 5));
+			check(b, false);
+		}
+	}
+	
+	
+	
+	/*---- Differential harness ----*/
+	
+	// Decodes the given input in every way and asserts that they all agree with the reference decoder on the output
+	// or on the type of exception thrown. Returns the output, or null if the input is truncated or malformed.
+	// Inflater must agree too if strict is true; otherwise only its successful outputs are compared, because
+	// it rejects distances before the start of the output (which are defined as zeros here) among other things.
+	private static byte[] check(byte[] input, boolean strict) throws IOException, DataFormatException {
+		// Reference, which shares no code with the others
+		ReferenceDecoder ref = new ReferenceDecoder(input);
+		byte[] expect = null;
+		Exception expectEx = null;
+		try {
+			expect = ref.decode();
+		} catch (IOException|DataFormatException e) {
+			expectEx = e;
+		}
+		
+		for (int way = 1; way < NUM_WAYS; way++) {
+			try {
+				byte[] actual = decompress(way, input, expect != null ? expect.length : MAX_EXPANSION * input.length);
+				if (expectEx != null)
+					throw disagreement("Way " + way, input, "expected " + expectEx);
+				if (!Arrays.equals(expect, actual))
+					throw disagreement("Way " + way, input, "different output");
+			} catch (IOException|DataFormatException e) {
+				if (expectEx == null || e.getClass() != expectEx.getClass())
+					throw disagreement("Way " + way, input, e);
+			}
+		}
+		
+		// Window that keeps only a CRC of the output
+		ChecksumOutputWindow window = new ChecksumOutputWindow();
+		try {
+			new Decompressor(window).decompressStream(new ByteBufferBitInputStream(ByteBuffer.wrap(input)));
+			if (expectEx != null)
+				throw disagreement("Checksum window", input, "expected " + expectEx);
+			CRC32 crc = new CRC32();
+			crc.update(expect, 0, expect.length);
+			if (window.getLength() != expect.length || window.getCrc().getValue() != crc.getValue())
+				throw disagreement("Checksum window", input, "different output");
+		} catch (IOException|DataFormatException e) {
+			if (expectEx == null || e.getClass() != expectEx.getClass())
+				throw disagreement("Checksum window", input, e);
+		}
+		
+		checkZlib(input, expect, expect != null ? ref.getEndIndex() : input.length, expectEx);
+		checkGzip(input, expect, expect != null ? ref.getEndIndex() : input.length, expectEx);
+		checkSeekIndex(input, expect, expectEx);
+		
+		try {
+			byte[] actual = inflate(input);
+			if (expectEx != null) {
+				if (strict)
+					throw disagreement("Inflater", input, "expected " + expectEx);
+			} else if (!Arrays.equals(expect, actual))
+				throw disagreement("Inflater", input, "different output");
+		} catch (EOFException|DataFormatException e) {
+			if (strict && (expectEx == null || e.getClass() != expectEx.getClass()))
+				throw disagreement("Inflater", input, e);
+		}
+		return expect;
+	}
+	
+	
+	// Asserts that ZlibDecompressor agrees with the reference on the given input, which is wrapped in a zlib header and
+	// followed by the Adler-32 of the expected output (if any) and one more byte, with the DEFLATE data cut at
+	// the given end index. The decoder must stop just after the checksum, and must reject a damaged one.
+	private static void checkZlib(byte[] input, byte[] expect, int end, Exception expectEx) throws IOException {
+		ByteArrayOutputStream bout = new ByteArrayOutputStream();
+		bout.write(new byte[]{0x78, 0x01});  // Window size 32 KiB, no dictionary, header check a multiple of 31
+		bout.write(input, 0, end);
+		if (expect != null) {
+			Adler32 adler = new Adler32();
+			adler.update(expect, 0, expect.length);
+			int value = (int)adler.getValue();
+			bout.write(new byte[]{(byte)(value >>> 24), (byte)(value >>> 16), (byte)(value >>> 8), (byte)value, (byte)0xA5});
+		}
+		byte[] zlib = bout.toByteArray();
+		
+		try {
+			BitInputStream in = new BufferedBitInputStream(new ByteArrayInputStream(zlib));
+			byte[] actual = ZlibDecompressor.decompress(in, null);
+			if (expectEx != null)
+				throw disagreement("Zlib", input, "expected " + expectEx);
+			if (!Arrays.equals(expect, actual) || in.readByte() != 0xA5)
+				throw disagreement("Zlib", input, "different output or end");
+		} catch (IOException|DataFormatException e) {
+			if (expectEx == null || e.getClass() != expectEx.getClass())
+				throw disagreement("Zlib", input, e);
+		}
+		
+		if (expect != null) {
+			zlib[zlib.length - 2 - rand.nextInt(4)] ^= 1 << rand.nextInt(8);
+			try {
+				ZlibDecompressor.decompress(new BufferedBitInputStream(new ByteArrayInputStream(zlib)), null);
+				throw disagreement("Zlib", input, "damaged Adler-32 accepted");
+			} catch (DataFormatException e) {}  // Pass
+		}
+	}
+	
+	
+	// Asserts that the gzip program's member loop agrees with the reference on the given input, wrapped in a gzip header
+	// and followed by the CRC-32 and length of the expected output (if any), with the DEFLATE data cut at the given end
+	// index. A valid member is repeated, so that the second one decodes after the state left by the first. A damaged
+	// footer must be rejected.
+	private static void checkGzip(byte[] input, byte[] expect, int end, Exception expectEx) throws IOException {
+		ByteArrayOutputStream bout = new ByteArrayOutputStream();
+		for (int i = 0; i < (expect != null ? 2 : 1); i++) {
+			bout.write(new byte[]{0x1F, (byte)0x8B, 8, 0, 0, 0, 0, 0, 0, (byte)0xFF});  // No flags, unknown OS
+			bout.write(input, 0, end);
+			if (expect != null) {
+				CRC32 crc = new CRC32();
+				crc.update(expect, 0, expect.length);
+				int value = (int)crc.getValue();
+				int len = expect.length;
+				bout.write(new byte[]{(byte)value, (byte)(value >>> 8), (byte)(value >>> 16), (byte)(value >>> 24),
+					(byte)len, (byte)(len >>> 8), (byte)(len >>> 16), (byte)(len >>> 24)});
+			}
+		}
+		byte[] gzip = bout.toByteArray();
+		
+		try {
+			ByteArrayOutputStream out = new ByteArrayOutputStream();
+			GzipDecompress.decompressMembers(new ByteBufferBitInputStream(ByteBuffer.wrap(gzip)), out, null);
+			if (expectEx != null)
+				throw disagreement("Gzip", input, "expected " + expectEx);
+			byte[] actual = out.toByteArray();
+			if (actual.length != expect.length * 2
+					|| !Arrays.equals(expect, Arrays.copyOf(actual, expect.length))
+					|| !Arrays.equals(expect, Arrays.copyOfRange(actual, expect.length, actual.length)))
+				throw disagreement("Gzip", input, "different output");
+		} catch (IOException|DataFormatException e) {
+			if (expectEx == null || e.getClass() != expectEx.getClass())
+				throw disagreement("Gzip", input, e);
+		}
+		
+		if (expect != null) {
+			gzip[gzip.length - 1 - rand.nextInt(8)] ^= 1 << rand.nextInt(8);
+			try {
+				GzipDecompress.decompressMembers(new ByteBufferBitInputStream(ByteBuffer.wrap(gzip)), null, null);
+				throw disagreement("Gzip", input, "damaged footer accepted");
+			} catch (DataFormatException e) {}  // Pass
+		}
+	}
+	
+	
+	// Asserts that a seek index built over the given input agrees with the reference on its total size, or on
+	// the type of exception thrown, and that reading a few random ranges through it gives the expected output.
+	private static void checkSeekIndex(byte[] input, byte[] expect, Exception expectEx) {
+		try {
+			ByteBuffer buf = ByteBuffer.wrap(input);
+			SeekIndex index = SeekIndex.build(buf, rand.nextInt(2000) + 1);
+			if (expectEx != null)
+				throw disagreement("Seek index", input, "expected " + expectEx);
+			if (index.getUncompressedSize() != expect.length)
+				throw disagreement("Seek index", input, "different size");
+			buf.position(0);
+			for (int i = 0; i < 3; i++) {
+				int offset = rand.nextInt(expect.length + 1);
+				byte[] b = new byte[rand.nextInt(3000) + 1];
+				int n = index.read(buf, offset, b, 0, b.length);
+				int expectN = offset == expect.length ? -1 : Math.min(b.length, expect.length - offset);
+				if (n != expectN || n > 0 && !Arrays.equals(Arrays.copyOfRange(expect, offset, offset + n), Arrays.copyOf(b, n)))
+					throw disagreement("Seek index", input, "different output at offset " + offset);
+			}
+		} catch (IOException|DataFormatException e) {
+			if (expectEx == null || e.getClass() != expectEx.getClass())
+				throw disagreement("Seek index", input, e);
+		}
+	}
+	
+	
+	// Returns an error saying that the given decoder disagrees with the reference on the given input,
+	// with the input in hexadecimal for adding to the corpus. The detail can be the exception thrown.
+	private static AssertionError disagreement(String decoder, byte[] input, Object detail) {
+		AssertionError result = new AssertionError(decoder + " disagrees on input " + toHex(input) + " (seed " + SEED + "): " + detail);
+		if (detail instanceof Throwable)
+			result.initCause((Throwable)detail);
+		return result;
+	}
+	
+	
+	// Decompresses the given whole input in the given way (from 1 to NUM_WAYS - 1),
+	// where the output is known to be at most the given length.
+	private static byte[] decompress(int way, byte[] input, int maxOutput) throws IOException, DataFormatException {
+		switch (way) {
+			case 1: {  // Bit-at-a-time stream through the instrumented loops, whose statistics must add up
+				ByteArrayOutputStream out = new ByteArrayOutputStream();
+				final long[] total = {0};
+				Decompressor.decompress(new ByteBitInputStream(new ByteArrayInputStream(input)), out, new DecompressorListener() {
+					public void blockDecoded(BlockStatistics stats) {
+						total[0] += stats.uncompressedBytes;
+					}
+				});
+				Assert.assertEquals("Seed " + SEED, out.size(), total[0]);
+				return out.toByteArray();
+			}
+			
+			case 2:  // Peekable stream with a small buffer, so that peeks often straddle a refill
+				return Decompressor.decompress(new BufferedBitInputStream(new ByteArrayInputStream(input), rand.nextInt(20) + 1));
+			
+			case 3: {  // Peekable stream, with the output written to a stream through a byte history
+				ByteArrayOutputStream out = new ByteArrayOutputStream();
+				Decompressor.decompress(new BufferedBitInputStream(new ByteArrayInputStream(input)), out);
+				return out.toByteArray();
+			}
+			
+			case 4: {  // Heap byte buffer with surrounding data
+				ByteBuffer buf = ByteBuffer.allocate(input.length + 4);
+				buf.put(new byte[3]).put(input).put((byte)0xA5);
+				buf.position(3);
+				buf.limit(3 + input.length);
+				return Decompressor.decompress(buf);
+			}
+			
+			case 5: {  // Direct byte buffer, with the output written to a stream
+				ByteBuffer buf = ByteBuffer.allocateDirect(input.length);
+				buf.put(input).flip();
+				ByteArrayOutputStream out = new ByteArrayOutputStream();
+				Decompressor.decompress(buf, out);
+				return out.toByteArray();
+			}
+			
+			case 6: {  // Resumable decompressor over a peekable stream, with output arrays of random lengths
+				ResumableDecompressor decomp = new ResumableDecompressor(new BufferedBitInputStream(new ByteArrayInputStream(input)));
+				ByteArrayOutputStream out = new ByteArrayOutputStream();
+				byte[] buf = new byte[300];
+				while (true) {
+					int n = decomp.decompress(buf, 0, rand.nextInt(buf.length));
+					if (n == -1)
+						break;
+					out.write(buf, 0, n);
+				}
+				return out.toByteArray();
+			}
+			
+			case 7: {  // Reused resumable decompressor with the input fed in short pieces
+				ResumableDecompressor decomp = SHARED_DECOMPRESSOR;
+				decomp.reset();
+				ByteArrayOutputStream out = new ByteArrayOutputStream();
+				byte[] buf = new byte[1000];
+				int index = 0;
+				while (true) {
+					int n = decomp.decompress(buf, 0, rand.nextInt(buf.length) + 1);
+					if (n == -1)
+						break;
+					out.write(buf, 0, n);
+					if (decomp.needsInput()) {
+						if (index == input.length)
+							throw new EOFException();  // Truncated input never finishes
+						int len = Math.min(rand.nextInt(50) + 1, input.length - index);
+						decomp.feed(input, index, len);
+						index += len;
+					}
+				}
+				return out.toByteArray();
+			}
+			
+			case 8: {  // Pooled decompressor into an output range of exactly the maximum length
+				byte[] buf = new byte[maxOutput + 2];
+				int n = POOL.decompress(input, 0, input.length, buf, 1, maxOutput);
+				return Arrays.copyOfRange(buf, 1, 1 + n);
+			}
+			
+			case 9: {  // Reused channel decompressor with the input fed in pieces of random sizes
+				ChannelDecompressor decomp = SHARED_CHANNEL_DECOMPRESSOR;
+				decomp.reset();
+				ByteArrayOutputStream out = new ByteArrayOutputStream();
+				int index = 0;
+				while (!decomp.isFinished()) {
+					if (decomp.needsInput()) {
+						if (index == input.length)
+							throw new EOFException();
+						int len = Math.min(rand.nextInt(500) + 1, input.length - index);
+						decomp.feed(ByteBuffer.wrap(input, index, len));
+						index += len;
+					}
+					ByteBuffer buf = rand.nextBoolean() ? ByteBuffer.allocate(rand.nextInt(2000)) : ByteBuffer.allocateDirect(rand.nextInt(2000));
+					decomp.decompress(buf);
+					buf.flip();
+					byte[] b = new byte[buf.remaining()];
+					buf.get(b);
+					out.write(b);
+				}
+				return out.toByteArray();
+			}
+			
+			case 10: {  // Parallel speculative decoding with small chunks
+				ByteArrayOutputStream out = new ByteArrayOutputStream();
+				ParallelDecompressor.decompress(ByteBuffer.wrap(input), out, 3, rand.nextInt(2000) + 1);
+				return out.toByteArray();
+			}
+			
+			case 11: {  // Batch after another stream, which leaves state behind in the shared decoder
+				BatchDecompressor.Result result = BatchDecompressor.decompress(
+					new byte[][]{BATCH_PREFIX, input}, new int[]{0, 0}, new int[]{BATCH_PREFIX.length, input.length});
+				Assert.assertArrayEquals("Seed " + SEED, BATCH_PREFIX_OUTPUT, Arrays.copyOf(result.data, result.offsets[1]));
+				return Arrays.copyOfRange(result.data, result.offsets[1], result.offsets[2]);
+			}
+			
+			case 12:  // Limits that never trip, but put the input behind a counting stream
+				return Decompressor.decompress(new BufferedBitInputStream(new ByteArrayInputStream(input)),
+					new DecompressionLimits(Long.MAX_VALUE, MAX_EXPANSION + 1));
+			
+			case 13:  // Bit-at-a-time stream, with the output collected in an array window
+				return Decompressor.decompress(new ByteBitInputStream(new ByteArrayInputStream(input)));
+			
+			default:
+				throw new IllegalArgumentException();
+		}
+	}
+	
+	
+	// Decompresses the given raw DEFLATE data with java.util.zip.Inflater, throwing
+	// EOFException if the data is truncated (in the same way as Decompressor).
+	private static byte[] inflate(byte[] input) throws EOFException, DataFormatException {
+		Inflater inf = new Inflater(true);
+		try {
+			inf.setInput(input);
+			ByteArrayOutputStream out = new ByteArrayOutputStream();
+			byte[] buf = new byte[4096];
+			while (!inf.finished()) {
+				int n = inf.inflate(buf);
+				out.write(buf, 0, n);
+				if (n == 0 && inf.needsInput())
+					throw new EOFException();
+			}
+			return out.toByteArray();
+		} finally {
+			inf.end();
+		}
+	}
+	
+	
+	
+	/*---- Reference decoder ----*/
+	
+	// A plain decoder to check the others against, written from RFC 1951 without any of their code. It reads one bit
+	// at a time and extends the bits of a code until they match one in a map built from the code lengths, and it
+	// rejects the same malformed data in the same order as Decompressor. Bytes before the output read as zeros.
+	private static final class ReferenceDecoder {
+		
+		private final byte[] input;
+		private long bitIndex = 0;
+		private byte[] output = new byte[64];
+		private int outputLength = 0;
+		
+		
+		public ReferenceDecoder(byte[] input) {
+			this.input = input;
+		}
+		
+		
+		public byte[] decode() throws IOException, DataFormatException {
+			boolean isFinal;
+			do {
+				isFinal = readInt(1) == 1;
+				int type = readInt(2);
+				if (type == 0)
+					decodeStoredBlock();
+				else if (type == 1)
+					decodeHuffmanBlock(FIXED_LITERAL_LENGTH_CODE, FIXED_DISTANCE_CODE);
+				else if (type == 2)
+					decodeDynamicBlock();
+				else
+					throw new DataFormatException("Reserved block type");
+			} while (!isFinal);
+			return Arrays.copyOf(output, outputLength);
+		}
+		
+		
+		// Returns the index of the first input byte after the final block, after decode() has returned.
+		public int getEndIndex() {
+			return (int)((bitIndex + 7) >>> 3);
+		}
+		
+		
+		private void decodeStoredBlock() throws IOException, DataFormatException {
+			bitIndex = (bitIndex + 7) & ~7;
+			int len = readInt(16);
+			if ((len ^ 0xFFFF) != readInt(16))
+				throw new DataFormatException("Invalid length in stored block");
+			for (int i = 0; i < len; i++)
+				write(readInt(8));
+		}
+		
+		
+		private void decodeDynamicBlock() throws IOException, DataFormatException {
+			int numLitLenCodes = readInt(5) + 257;
+			int numDistCodes = readInt(5) + 1;
+			int numCodeLenCodes = readInt(4) + 4;
+			int[] codeLenCodeLens = new int[19];
+			for (int i = 0; i < numCodeLenCodes; i++)
+				codeLenCodeLens[CODE_LENGTH_ORDER[i]] = readInt(3);
+			Map<Integer,Integer> codeLenCode = makeCode(codeLenCodeLens);
+			if (codeLenCode == null)
+				throw new DataFormatException("Invalid code length code");
+			
+			int[] codeLens = new int[numLitLenCodes + numDistCodes];
+			for (int i = 0; i < codeLens.length; ) {
+				int sym = decodeSymbol(codeLenCode);
+				if (sym <= 15) {
+					codeLens[i] = sym;
+					i++;
+					continue;
+				}
+				int value = 0;
+				int count;
+				if (sym == 16) {
+					if (i == 0)
+						throw new DataFormatException("Repeat without a previous code length");
+					value = codeLens[i - 1];
+					count = readInt(2) + 3;
+				} else if (sym == 17)
+					count = readInt(3) + 3;
+				else
+					count = readInt(7) + 11;
+				if (i + count > codeLens.length)
+					throw new DataFormatException("Run exceeds number of codes");
+				for (int j = 0; j < count; j++, i++)
+					codeLens[i] = value;
+			}
+			
+			Map<Integer,Integer> litLenCode = makeCode(Arrays.copyOf(codeLens, numLitLenCodes));
+			if (litLenCode == null)
+				throw new DataFormatException("Invalid literal/length code");
+			int[] distCodeLens = Arrays.copyOfRange(codeLens, numLitLenCodes, codeLens.length);
+			Map<Integer,Integer> distCode = null;  // No distance code if there is only one code length and it is zero
+			if (distCodeLens.length > 1 || distCodeLens[0] != 0) {
+				// A lone code of length 1 is completed by an unused code for symbol 31
+				int numOnes = 0;
+				int numOthers = 0;
+				for (int x : distCodeLens) {
+					if (x == 1)
+						numOnes++;
+					else if (x > 1)
+						numOthers++;
+				}
+				if (numOnes == 1 && numOthers == 0) {
+					distCodeLens = Arrays.copyOf(distCodeLens, 32);
+					distCodeLens[31] = 1;
+				}
+				distCode = makeCode(distCodeLens);
+				if (distCode == null)
+					throw new DataFormatException("Invalid distance code");
+			}
+			decodeHuffmanBlock(litLenCode, distCode);
+		}
+		
+		
+		private void decodeHuffmanBlock(Map<Integer,Integer> litLenCode, Map<Integer,Integer> distCode) throws IOException, DataFormatException {
+			while (true) {
+				int sym = decodeSymbol(litLenCode);
+				if (sym < 256) {
+					write(sym);
+					continue;
+				}
+				if (sym == 256)
+					break;
+				
+				int len;
+				if (sym <= 264)
+					len = sym - 254;
+				else if (sym <= 284) {
+					int numExtra = (sym - 261) / 4;
+					len = (((sym - 265) % 4 + 4) << numExtra) + 3 + readInt(numExtra);
+				} else if (sym == 285)
+					len = 258;
+				else
+					throw new DataFormatException("Reserved length symbol");
+				
+				if (distCode == null)
+					throw new DataFormatException("Length without a distance code");
+				int distSym = decodeSymbol(distCode);
+				int dist;
+				if (distSym <= 3)
+					dist = distSym + 1;
+				else if (distSym <= 29) {
+					int numExtra = distSym / 2 - 1;
+					dist = ((distSym % 2 + 2) << numExtra) + 1 + readInt(numExtra);
+				} else
+					throw new DataFormatException("Reserved distance symbol");
+				
+				for (int i = 0; i < len; i++)
+					write(outputLength >= dist ? output[outputLength - dist] : 0);
+			}
+		}
+		
+		
+		// Returns a map from each code, with a 1 bit prepended to keep the leading zeros, to its symbol,
+		// or null if the code lengths do not make a full code tree (neither over-full nor under-full).
+		private static Map<Integer,Integer> makeCode(int[] codeLens) {
+			Map<Integer,Integer> result = new HashMap<>();
+			int nextCode = 0;
+			for (int len = 1; len <= 15; len++) {
+				nextCode <<= 1;
+				for (int sym = 0; sym < codeLens.length; sym++) {
+					if (codeLens[sym] != len)
+						continue;
+					if (nextCode >= 1 << len)
+						return null;
+					result.put(1 << len | nextCode, sym);
+					nextCode++;
+				}
+			}
+			return nextCode == 1 << 15 ? result : null;
+		}
+		
+		
+		private int decodeSymbol(Map<Integer,Integer> code) throws EOFException {
+			int bits = 1;
+			while (true) {
+				bits = bits << 1 | readInt(1);
+				Integer sym = code.get(bits);
+				if (sym != null)
+					return sym;
+			}
+		}
+		
+		
+		// Reads the given number of bits in little endian, throwing EOFException at the end of the input.
+		private int readInt(int numBits) throws EOFException {
+			int result = 0;
+			for (int i = 0; i < numBits; i++, bitIndex++) {
+				if (bitIndex >= input.length * 8L)
+					throw new EOFException();
+				result |= (input[(int)(bitIndex >>> 3)] >>> (bitIndex & 7) & 1) << i;
+			}
+			return result;
+		}
+		
+		
+		private void write(int b) {
+			if (outputLength == output.length)
+				output = Arrays.copyOf(output, output.length * 2);
+			output[outputLength] = (byte)b;
+			outputLength++;
+		}
+		
+		
+		private static final int[] CODE_LENGTH_ORDER = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+		
+		private static final Map<Integer,Integer> FIXED_LITERAL_LENGTH_CODE;
+		private static final Map<Integer,Integer> FIXED_DISTANCE_CODE;
+		
+		static {
+			int[] litLenCodeLens = new int[288];
+			Arrays.fill(litLenCodeLens,   0, 144, 8);
+			Arrays.fill(litLenCodeLens, 144, 256, 9);
+			Arrays.fill(litLenCodeLens, 256, 280, 7);
+			Arrays.fill(litLenCodeLens, 280, 288, 8);
+			FIXED_LITERAL_LENGTH_CODE = makeCode(litLenCodeLens);
+			int[] distCodeLens = new int[32];
+			Arrays.fill(distCodeLens, 5);
+			FIXED_DISTANCE_CODE = makeCode(distCodeLens);
+		}
+		
+	}
+	
+	
+	
+	/*---- Input generation ----*/
+	
+	// Returns random data of the given length in one of several styles, so that the compressor
+	// chooses assorted block types, literal alphabets, match lengths, and distances.
+	private static byte[] randomData(int len) {
+		byte[] result = new byte[len];
+		int style = rand.nextInt(4);
+		if (style == 0)
+			rand.nextBytes(result);
+		else if (style == 1) {
+			int alphabet = rand.nextInt(16) + 1;
+			for (int i = 0; i < len; i++)
+				result[i] = (byte)rand.nextInt(alphabet);
+		} else if (style == 2) {
+			// Long runs of a few values
+			for (int i = 0; i < len; ) {
+				byte b = (byte)(rand.nextInt(3) * 100);
+				for (int end = Math.min(i + rand.nextInt(2000), len); i < end; i++)
+					result[i] = b;
+			}
+		} else {
+			// Text-like data whose character set shifts around, with repeats up to the maximum distance
+			for (int i = 0; i < len; ) {
+				if (i >= 10 && rand.nextInt(4) == 0) {
+					int dist = rand.nextInt(10) == 0 ? Math.min(i, 32768) : rand.nextInt(Math.min(i, 32768)) + 1;
+					for (int end = Math.min(i + rand.nextInt(300), len); i < end; i++)
+						result[i] = result[i - dist];
+				} else {
+					int base = 'a' + (i >>> 12) % 20;
+					for (int end = Math.min(i + rand.nextInt(10), len); i < end; i++)
+						result[i] = (byte)(base + rand.nextInt(7));
+				}
+			}
+		}
+		return result;
+	}
+	
+	
+	// Returns a raw DEFLATE compression of the given data, where the settings are random and may change partway
+	// through, and pieces may end with flushes, so that the stream mixes stored, fixed, and dynamic blocks.
+	private static byte[] compressRandomly(byte[] data) {
+		Deflater def = new Deflater(rand.nextInt(10), true);
+		def.setStrategy(STRATEGIES[rand.nextInt(STRATEGIES.length)]);
+		ByteArrayOutputStream bout = new ByteArrayOutputStream();
+		byte[] buf = new byte[4096];
+		for (int off = 0; off < data.length; ) {
+			int len = Math.min(rand.nextInt(30000) + 1, data.length - off);
+			def.setInput(data, off, len);
+			off += len;
+			int flush = FLUSH_MODES[rand.nextInt(FLUSH_MODES.length)];
+			int n;
+			do {
+				n = def.deflate(buf, 0, buf.length, flush);
+				bout.write(buf, 0, n);
+			} while (!def.needsInput() || n == buf.length);
+			if (rand.nextInt(4) == 0) {
+				def.setLevel(rand.nextInt(10));
+				def.setStrategy(STRATEGIES[rand.nextInt(STRATEGIES.length)]);
+			}
+		}
+		def.finish();
+		while (!def.finished())
+			bout.write(buf, 0, def.deflate(buf));
+		def.end();
+		return bout.toByteArray();
+	}
+	
+	
+	// Returns a copy of the given data with one random kind of damage.
+	private static byte[] mutate(byte[] b) {
+		if (b.length == 0)
+			return b;
+		b = b.clone();
+		int i = rand.nextInt(b.length);
+		switch (rand.nextInt(5)) {
+			case 0:  // Flip one bit
+				b[i] ^= 1 << rand.nextInt(8);
+				return b;
+			case 1:  // Replace one byte
+				b[i] = (byte)rand.nextInt(256);
+				return b;
+			case 2:  // Truncate
+				return Arrays.copyOf(b, i);
+			case 3: {  // Delete or insert a few bytes, which shifts the rest of the bit stream
+				int len = Math.min(rand.nextInt(4) + 1, b.length - i);
+				if (rand.nextBoolean()) {
+					byte[] result = new byte[b.length - len];
+					System.arraycopy(b, 0, result, 0, i);
+					System.arraycopy(b, i + len, result, i, result.length - i);
+					return result;
+				} else {
+					byte[] result = new byte[b.length + len];
+					System.arraycopy(b, 0, result, 0, i);
+					System.arraycopy(b, i, result, i + len, b.length - i);
+					for (int j = 0; j < len; j++)
+						result[i + j] = (byte)rand.nextInt(256);
+					return result;
+				}
+			}
+			case 4: {  // Copy a range over another place in the stream
+				int j = rand.nextInt(b.length);
+				int len = rand.nextInt(Math.min(b.length - Math.max(i, j), 100) + 1);
+				System.arraycopy(b, i, b, j, len);
+				return b;
+			}
+			default:
+				throw new AssertionError();
+		}
+	}
+	
+	
+	private static byte[] parseHex(String s) {
+		byte[] result = new byte[s.length() / 2];
+		for (int i = 0; i < result.length; i++)
+			result[i] = (byte)Integer.parseInt(s.substring(i * 2, (i + 1) * 2), 16);
+		return result;
+	}
+	
+	
+	private static String toHex(byte[] b) {
+		StringBuilder sb = new StringBuilder();
+		for (byte x : b)
+			sb.append(String.format("%02X", x));
+		return sb.toString();
+	}
+	
+	
+	
+	/*---- Regression corpus ----*/
+	
+	// Hand-written edge cases and past failures, as hexadecimal bytes. Some are valid and some are not;
+	// the harness only requires every decoder to agree on each one.
+	private static final String[] CORPUS = {
+		// Empty input
+		"",
+		// Two stored blocks
+		"000200FDFF0514010100FEFF23",
+		// Stored block whose length does not match its complement
+		"0104089FAC",
+		// Reserved block type
+		"07",
+		// Fixed block with literals of every code length
+		"6368E89F70E03F00",
+		// Fixed block with an overlapping copy
+		"63040100",
+		// Fixed block with a copy at distance 2
+		"EBEB074300",
+		// Fixed block: literal, then a copy of length 258 at distance 1
+		"AB180500",
+		// Fixed block: copy of length 3 at distance 32768 before any output
+		"03DEFFEF0800",
+		// Fixed block: length 257 from symbol 284 with all extra bits set
+		"6318F90000",
+		// Fixed block: reserved length symbol 286
+		"6318030000",
+		// Fixed block: reserved distance symbol 30
+		"63003E0000",
+		// Fixed block whose padding bits complete a copy, without an end of block
+		"634002",
+		// Stored block, then a fixed block copying across the boundary
+		"000400FBFF61626364036100",
+		// Dynamic block that is empty
+		"05E181000000000010F8AF46",
+		// Dynamic block of literals without a distance code
+		"05C0810800000000207FEA0F01",
+		// Dynamic block with one distance code
+		"0DC001090000008020FA7FDA6C00",
+		// Dynamic block using the unused code of a one-symbol distance code
+		"0DC001090000008020FA7FDAEC00",
+		// Dynamic block with a length but no distance code
+		"0DC0010900000080A0FEAF361A0000",
+		// Dynamic block whose code lengths start with a repeat
+		"05C003000000000090",
+		// Dynamic block with too many code lengths
+		"05C081000000000010FEB301",
+		// Dynamic block with an overfull code length code
+		"050092000000",
+		// Dynamic block with an underfull code length code
+		"050014000000",
+		// Full and sync flushes between dynamic, fixed, and empty stored blocks
+		"0AC94855282CCD4CCE56482ACA2FCF5348CBAF50C82ACD2D2856C82F4B2D5228014AE72456552AA4E4A7EB2984D04C31000000FFFF62E0149256D135B3F708"
+			+ "8C4ACE29AD6B9F3073D1EA2D7B8F9DBFF1F0D5E73F00000000FFFF0300",
+		// Run-length strategy, with many copies at distances 1 and 2
+		"EDC1410180000800316FA981F4A6F0E7F6FC7E1F489224499224499224499224499224499224499224499224499224499224499224499224499224499224"
+			+ "499224499224499224499224499264F6666FF6666FF6666FF6666FF6666FF6666FF6666FF6666FF6666FF6666FF6666FF6666FF6666FF6666FF6666FF6"
+			+ "666FF6666FF6666FF6666FF666EF05",
+		// Huffman-only strategy, a dynamic block without any copies
+		"05C10101000008C2B02A543B9A80946A2A371C8AC64138148D8370281A07E150340EC2A1681C8443D13868F6666FF6666FF61E",
+		// Sync flush without a final block, which is truncated
+		"4A4C4A844200000000FFFF",
+	};
+	
+	
+	
+	/*---- Constants ----*/
+	
+	private static final int NUM_WAYS = 14;
+	
+	// No stream expands by more than this factor: each copy of 258 bytes takes at least 2 bits.
+	private static final int MAX_EXPANSION = 1032;
+	
+	private static final int[] STRATEGIES = {Deflater.DEFAULT_STRATEGY, Deflater.FILTERED, Deflater.HUFFMAN_ONLY};
+	
+	private static final int[] FLUSH_MODES = {Deflater.NO_FLUSH, Deflater.NO_FLUSH, Deflater.SYNC_FLUSH, Deflater.FULL_FLUSH};
+	
+	// Dynamic Huffman block with one distance code, which decodes to 01 01 01 01.
+	private static final byte[] BATCH_PREFIX = parseHex("0DC001090000008020FA7FDA6C00");
+	
+	private static final byte[] BATCH_PREFIX_OUTPUT = {1, 1, 1, 1};
+	
+	private static final ResumableDecompressor SHARED_DECOMPRESSOR = new ResumableDecompressor();
+	
+	private static final ChannelDecompressor SHARED_CHANNEL_DECOMPRESSOR = new ChannelDecompressor();
+	
+	private static final DecompressorPool POOL = new DecompressorPool(2);
+	
+	// Random unless given, and reported in every failure so that the run can be repeated.
+	private static final long SEED = Long.getLong("fuzz.seed", System.nanoTime());
+	
+	private static Random rand = new Random(SEED);
+	
+}
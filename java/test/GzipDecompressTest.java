@@ -0,0 +1,140 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.nio.file.DirectoryStream;
+import java.nio.file.Files;
+import java.nio.file.Path;
+import java.util.Arrays;
+import java.util.Random;
+import java.util.zip.Deflater;
+import java.util.zip.GZIPOutputStream;
+import org.junit.Assert;
+import org.junit.Test;
+
+
+public final class GzipDecompressTest {
+	
+	@Test public void testBatchWithBadFiles() throws IOException {
+		Path inDir = Files.createTempDirectory("GzipDecompressTest");
+		Path outDir = inDir.resolve("out");
+		try {
+			int numFiles = 8;
+			byte[][] datas = new byte[numFiles][];
+			for (int i = 0; i < numFiles; i++) {
+				datas[i] = randomData(rand.nextInt(200000));
+				byte[] gz = gzip(datas[i]);
+				if (i == 2)
+					gz[10] = 0x07;  // The first block has the reserved type
+				else if (i == 5)
+					gz = Arrays.copyOf(gz, gz.length - 5);  // Truncated footer
+				Files.write(inDir.resolve("file" + i + ".gz"), gz);
+			}
+			
+			// The bad files are reported and skipped, and the rest are still decompressed
+			String msg = GzipDecompress.submain(new String[]{"-b", "-q", "-j", "3", inDir.toString(), outDir.toString()});
+			Assert.assertEquals("2 of " + numFiles + " files failed", msg);
+			for (int i = 0; i < numFiles; i++) {
+				Path outFile = outDir.resolve("file" + i);
+				if (i == 2 || i == 5)
+					Assert.assertFalse(Files.exists(outFile));
+				else
+					Assert.assertArrayEquals(datas[i], Files.readAllBytes(outFile));
+			}
+		} finally {
+			deleteRecursively(inDir);
+		}
+	}
+	
+	
+	@Test public void testMultipleMembersInEveryMode() throws IOException {
+		Path dir = Files.createTempDirectory("GzipDecompressTest");
+		try {
+			// Members at assorted levels, so that there are stored, fixed, and dynamic blocks
+			ByteArrayOutputStream expect = new ByteArrayOutputStream();
+			ByteArrayOutputStream gz = new ByteArrayOutputStream();
+			for (int i = 0; i < 10; i++) {
+				byte[] data = randomData(rand.nextInt(i % 3 == 0 ? 1000000 : 1000));
+				expect.write(data);
+				gz.write(gzip(data, rand.nextInt(10)));
+			}
+			Path inFile = dir.resolve("in.gz");
+			Path outFile = dir.resolve("out");
+			Files.write(inFile, gz.toByteArray());
+			
+			String[][] modes = {{}, {"-p"}, {"-j", "3"}};
+			for (String[] mode : modes) {
+				String[] args = Arrays.copyOf(mode, mode.length + 2);
+				args[mode.length] = inFile.toString();
+				args[mode.length + 1] = outFile.toString();
+				Assert.assertNull(GzipDecompress.submain(args));
+				Assert.assertArrayEquals(expect.toByteArray(), Files.readAllBytes(outFile));
+			}
+			Assert.assertNull(GzipDecompress.submain(new String[]{"-t", inFile.toString()}));
+		} finally {
+			deleteRecursively(dir);
+		}
+	}
+	
+	
+	@Test(timeout=60000)
+	public void testPipelinedWithLongTrailingData() throws IOException {
+		// More trailing data than the pipeline's input pieces can hold, which the reader must not wait to hand over
+		Path dir = Files.createTempDirectory("GzipDecompressTest");
+		try {
+			byte[] data = randomData(300000);
+			byte[] gz = gzip(data);
+			Path inFile = dir.resolve("in.gz");
+			Path outFile = dir.resolve("out");
+			Files.write(inFile, Arrays.copyOf(gz, gz.length + 6 * 1024 * 1024));  // Zeros after the member
+			Assert.assertNull(GzipDecompress.submain(new String[]{"-p", inFile.toString(), outFile.toString()}));
+			Assert.assertArrayEquals(data, Files.readAllBytes(outFile));
+		} finally {
+			deleteRecursively(dir);
+		}
+	}
+	
+	
+	private static byte[] gzip(byte[] data) throws IOException {
+		return gzip(data, Deflater.DEFAULT_COMPRESSION);
+	}
+	
+	
+	// Returns a single gzip member of the given data compressed at the given level.
+	private static byte[] gzip(byte[] data, final int level) throws IOException {
+		ByteArrayOutputStream bout = new ByteArrayOutputStream();
+		try (GZIPOutputStream out = new GZIPOutputStream(bout) {{ def.setLevel(level); }}) {
+			out.write(data);
+		}
+		return bout.toByteArray();
+	}
+	
+	
+	private static byte[] randomData(int len) {
+		byte[] result = new byte[len];
+		for (int i = 0; i < result.length; i++)
+			result[i] = (byte)('a' + rand.nextInt(rand.nextInt(26) + 1));
+		return result;
+	}
+	
+	
+	private static void deleteRecursively(Path path) throws IOException {
+		if (Files.isDirectory(path)) {
+			try (DirectoryStream<Path> entries = Files.newDirectoryStream(path)) {
+				for (Path p : entries)
+					deleteRecursively(p);
+			}
+		}
+		Files.deleteIfExists(path);
+	}
+	
+	
+	private static Random rand = new Random();
+	
+}
@@ -0,0 +1,60 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import org.junit.Assert;
+import org.junit.Test;
+
+
+public final class HuffmanTableCacheTest {
+	
+	@Test public void testReuse() {
+		HuffmanTableCache cache = new HuffmanTableCache();
+		int[] lens = {9, 1, 0, 3, 2, 3, 9};
+		CanonicalCode a = cache.get(lens, 1, 5);
+		CanonicalCode b = cache.get(new int[]{1, 0, 3, 2, 3}, 0, 5);
+		Assert.assertSame(a, b);
+		Assert.assertEquals(new CanonicalCode(new int[]{1, 0, 3, 2, 3}).toString(), a.toString());
+		
+		// Same lengths but a different alphabet size
+		CanonicalCode c = cache.get(new int[]{1, 0, 3, 2, 3, 0}, 0, 6);
+		Assert.assertNotSame(a, c);
+		
+		// Changing the caller's array afterward must not affect the cached entry
+		lens[1] = 2;
+		lens[2] = 2;
+		Assert.assertSame(a, cache.get(new int[]{1, 0, 3, 2, 3}, 0, 5));
+	}
+	
+	
+	@Test public void testBlockTableReuse() {
+		HuffmanTableCache cache = new HuffmanTableCache();
+		int[] litLenLens = new int[257];
+		litLenLens[0] = 1;
+		litLenLens[256] = 1;
+		CanonicalCode litLen = cache.get(litLenLens, 0, litLenLens.length);
+		CanonicalCode distA = cache.get(new int[]{1, 1}, 0, 2);
+		CanonicalCode distB = cache.get(new int[]{1, 2, 2}, 0, 3);
+		BlockDecodeTable a = cache.getBlockTable(litLen, distA);
+		Assert.assertSame(a, cache.getBlockTable(litLen, cache.get(new int[]{1, 1}, 0, 2)));
+		Assert.assertNotSame(a, cache.getBlockTable(litLen, distB));
+		cache.clear();
+		Assert.assertNotSame(a, cache.getBlockTable(litLen, distA));
+	}
+	
+	
+	@Test public void testInvalid() {
+		HuffmanTableCache cache = new HuffmanTableCache();
+		for (int i = 0; i < 2; i++) {
+			try {
+				cache.get(new int[]{1, 1, 1}, 0, 3);
+				Assert.fail();
+			} catch (IllegalArgumentException e) {}  // Pass
+		}
+	}
+	
+}
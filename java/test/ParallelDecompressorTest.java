@@ -0,0 +1,124 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.io.ByteArrayOutputStream;
+import java.io.EOFException;
+import java.io.IOException;
+import java.io.OutputStream;
+import java.nio.ByteBuffer;
+import java.util.Arrays;
+import java.util.Random;
+import java.util.zip.DataFormatException;
+import java.util.zip.Deflater;
+import org.junit.Assert;
+import org.junit.Test;
+
+
+public final class ParallelDecompressorTest {
+	
+	@Test public void testRandomly() throws IOException, DataFormatException {
+		for (int i = 0; i < 100; i++) {
+			// Compress text-like data whose character set shifts around, so that there are many dynamic blocks
+			byte[] data = new byte[rand.nextInt(300000)];
+			for (int j = 0; j < data.length; ) {
+				if (j >= 10 && rand.nextInt(4) == 0) {  // Repeat something earlier
+					int dist = rand.nextInt(Math.min(j, 40000)) + 1;
+					for (int end = Math.min(j + rand.nextInt(300), data.length); j < end; j++)
+						data[j] = data[j - dist];
+				} else {
+					int base = 'a' + (j >>> 14) % 20;
+					for (int end = Math.min(j + rand.nextInt(10), data.length); j < end; j++)
+						data[j] = (byte)(base + rand.nextInt(7));
+				}
+			}
+			byte[] comp = compress(data, rand.nextInt(10));
+			
+			// The DEFLATE data is surrounded by other bytes, which must be left alone
+			ByteBuffer buf = ByteBuffer.allocate(comp.length + 3);
+			buf.put((byte)1).put(comp).put((byte)2).put((byte)3);
+			buf.position(1);
+			ByteArrayOutputStream out = new ByteArrayOutputStream();
+			ParallelDecompressor.decompress(buf, out, rand.nextInt(4) + 1, rand.nextInt(5000) + 1);
+			Assert.assertArrayEquals(data, out.toByteArray());
+			Assert.assertEquals(1 + comp.length, buf.position());
+		}
+	}
+	
+	
+	@Test public void testMatchesSequentialOnErrors() throws IOException, DataFormatException {
+		for (int i = 0; i < 100; i++) {
+			byte[] data = new byte[rand.nextInt(20000)];
+			for (int j = 0; j < data.length; j++)
+				data[j] = (byte)('a' + rand.nextInt(j % 1000 < 500 ? 3 : 26));
+			byte[] comp = compress(data, 6);
+			
+			// Either truncate or damage the data
+			if (rand.nextBoolean())
+				comp = Arrays.copyOf(comp, rand.nextInt(comp.length));
+			else
+				comp[rand.nextInt(comp.length)] ^= 1 << rand.nextInt(8);
+			
+			Exception expect = null;
+			byte[] expectOut = null;
+			try {
+				expectOut = Decompressor.decompress(ByteBuffer.wrap(comp));
+			} catch (EOFException|DataFormatException e) {
+				expect = e;
+			}
+			ByteArrayOutputStream out = new ByteArrayOutputStream();
+			try {
+				ParallelDecompressor.decompress(ByteBuffer.wrap(comp), out, 3, rand.nextInt(500) + 1);
+				Assert.assertNull(expect);
+				Assert.assertArrayEquals(expectOut, out.toByteArray());
+			} catch (EOFException|DataFormatException e) {
+				Assert.assertNotNull(expect);
+				Assert.assertEquals(expect.getClass(), e.getClass());
+			}
+		}
+	}
+	
+	
+	@Test public void testHighlyCompressible() throws IOException, DataFormatException {
+		// Each chunk expands about 1000 times, beyond the limit of speculative output,
+		// so such chunks must be decoded in order and streamed to the output
+		int len = 32 << 20;
+		byte[] comp = compress(new byte[len], 9);
+		final long[] count = {0};
+		OutputStream out = new OutputStream() {
+			public void write(int b) {
+				write(new byte[]{(byte)b}, 0, 1);
+			}
+			
+			public void write(byte[] b, int off, int n) {
+				for (int i = 0; i < n; i++)
+					Assert.assertEquals(0, b[off + i]);
+				count[0] += n;
+			}
+		};
+		ParallelDecompressor.decompress(ByteBuffer.wrap(comp), out, 4, 4096);
+		Assert.assertEquals(len, count[0]);
+	}
+	
+	
+	// Returns the raw DEFLATE compression of the given data at the given level.
+	private static byte[] compress(byte[] data, int level) {
+		Deflater def = new Deflater(level, true);
+		def.setInput(data);
+		def.finish();
+		ByteArrayOutputStream bout = new ByteArrayOutputStream();
+		byte[] buf = new byte[4096];
+		while (!def.finished())
+			bout.write(buf, 0, def.deflate(buf));
+		def.end();
+		return bout.toByteArray();
+	}
+	
+	
+	private static Random rand = new Random();
+	
+}
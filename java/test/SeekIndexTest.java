@@ -0,0 +1,90 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.nio.ByteBuffer;
+import java.util.Arrays;
+import java.util.Random;
+import java.util.zip.DataFormatException;
+import java.util.zip.Deflater;
+import org.junit.Assert;
+import org.junit.Test;
+
+
+public final class SeekIndexTest {
+	
+	@Test public void testRandomly() throws IOException, DataFormatException {
+		for (int i = 0; i < 30; i++) {
+			// Make compressible data with long-distance repeats, and compress it into many blocks
+			byte[] data = new byte[rand.nextInt(500000)];
+			for (int j = 0; j < data.length; j++) {
+				if (j >= 1000 && rand.nextInt(3) == 0)
+					data[j] = data[j - 1000 - rand.nextInt(Math.min(j - 999, 30000))];
+				else
+					data[j] = (byte)('A' + rand.nextInt(j % 100000 < 50000 ? 4 : 30));
+			}
+			byte[] comp = compress(data, rand.nextInt(9) + 1);
+			
+			ByteBuffer buf = ByteBuffer.allocate(comp.length + 2);
+			buf.put((byte)7).put(comp).put((byte)8);
+			buf.position(1);
+			SeekIndex index = SeekIndex.build(buf, rand.nextInt(100000) + 1);
+			Assert.assertEquals(1 + comp.length, buf.position());
+			Assert.assertEquals(data.length, index.getUncompressedSize());
+			
+			// Round trip through the on-disk format
+			if (rand.nextBoolean()) {
+				ByteArrayOutputStream bout = new ByteArrayOutputStream();
+				index.writeTo(bout);
+				index = SeekIndex.readFrom(new ByteArrayInputStream(bout.toByteArray()));
+				Assert.assertEquals(data.length, index.getUncompressedSize());
+			}
+			
+			// Read random ranges
+			buf.position(1);
+			for (int j = 0; j < 30; j++) {
+				int offset = rand.nextInt(data.length + 10);
+				byte[] b = new byte[rand.nextInt(5000) + 1];
+				int n = index.read(buf, offset, b, 0, b.length);
+				if (offset >= data.length)
+					Assert.assertEquals(-1, n);
+				else {
+					Assert.assertEquals(Math.min(b.length, data.length - offset), n);
+					Assert.assertArrayEquals(Arrays.copyOfRange(data, offset, offset + n), Arrays.copyOf(b, n));
+				}
+				Assert.assertEquals(1, buf.position());
+			}
+		}
+	}
+	
+	
+	@Test(expected=DataFormatException.class)
+	public void testBadMagic() throws IOException, DataFormatException {
+		SeekIndex.readFrom(new ByteArrayInputStream(new byte[]{'D', 'F', 'I', 'Y', 1, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0}));
+	}
+	
+	
+	// Returns the raw DEFLATE compression of the given data at the given level.
+	private static byte[] compress(byte[] data, int level) {
+		Deflater def = new Deflater(level, true);
+		def.setInput(data);
+		def.finish();
+		ByteArrayOutputStream bout = new ByteArrayOutputStream();
+		byte[] buf = new byte[4096];
+		while (!def.finished())
+			bout.write(buf, 0, def.deflate(buf));
+		def.end();
+		return bout.toByteArray();
+	}
+	
+	
+	private static Random rand = new Random();
+	
+}
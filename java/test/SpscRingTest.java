@@ -0,0 +1,72 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.util.concurrent.CancellationException;
+import org.junit.Assert;
+import org.junit.Test;
+
+
+public final class SpscRingTest {
+	
+	@Test public void testOfferPoll() {
+		SpscRing<Integer> ring = new SpscRing<>(4);
+		Assert.assertNull(ring.poll());
+		for (int i = 0; i < 4; i++)
+			Assert.assertTrue(ring.offer(i));
+		Assert.assertFalse(ring.offer(4));  // Full
+		Assert.assertEquals(0, (int)ring.poll());
+		Assert.assertTrue(ring.offer(4));  // Wraps around
+		for (int i = 1; i <= 4; i++)
+			Assert.assertEquals(i, (int)ring.poll());
+		Assert.assertNull(ring.poll());
+	}
+	
+	
+	@Test public void testTwoThreads() throws InterruptedException {
+		final SpscRing<Integer> ring = new SpscRing<>(8);
+		final int count = 1000000;
+		Thread producer = new Thread() {
+			public void run() {
+				for (int i = 0; i < count; i++)
+					ring.put(i);
+			}
+		};
+		producer.start();
+		for (int i = 0; i < count; i++)
+			Assert.assertEquals(i, (int)ring.take());
+		producer.join();
+		Assert.assertNull(ring.poll());
+	}
+	
+	
+	@Test public void testClose() throws InterruptedException {
+		final SpscRing<Integer> ring = new SpscRing<>(2);
+		final boolean[] stopped = {false};
+		Thread consumer = new Thread() {
+			public void run() {
+				try {
+					ring.take();
+				} catch (CancellationException e) {
+					stopped[0] = true;
+				}
+			}
+		};
+		consumer.start();
+		Thread.sleep(10);
+		ring.close();
+		consumer.join();
+		Assert.assertTrue(stopped[0]);
+	}
+	
+	
+	@Test(expected=IllegalArgumentException.class)
+	public void testCapacityNotPowerOf2() {
+		new SpscRing<Integer>(6);
+	}
+	
+}
@@ -0,0 +1,145 @@
+/* 
+ * Simple DEFLATE decompressor
+ * Copyright (c) Project Nayuki
+ * 
+ * https://www.nayuki.io/page/simple-deflate-decompressor
+ * https://github.com/nayuki/Simple-DEFLATE-decompressor
+ */
+
+import java.io.ByteArrayInputStream;
+import java.io.ByteArrayOutputStream;
+import java.io.IOException;
+import java.util.Arrays;
+import java.util.Random;
+import java.util.zip.Adler32;
+import java.util.zip.DataFormatException;
+import java.util.zip.Deflater;
+import org.junit.Assert;
+import org.junit.Test;
+
+
+public final class ZlibDecompressorTest {
+	
+	@Test public void testRandomly() throws IOException, DataFormatException {
+		for (int i = 0; i < 300; i++) {
+			byte[] data = randomText(rand.nextInt(100000));
+			byte[] dict = null;
+			if (rand.nextBoolean())
+				dict = randomText(rand.nextInt(50000) + 1);
+			byte[] comp = compress(data, dict);
+			byte[] input = Arrays.copyOf(comp, comp.length + 1);
+			input[comp.length] = 0x5A;
+			
+			BitInputStream in = new BufferedBitInputStream(new ByteArrayInputStream(input));
+			Assert.assertArrayEquals(data, ZlibDecompressor.decompress(in, dict));
+			Assert.assertEquals(0x5A, in.readByte());
+		}
+	}
+	
+	
+	@Test public void testAdler32() {
+		for (int i = 0; i < 1000; i++) {
+			byte[] b = new byte[rand.nextInt(20000)];
+			for (int j = 0; j < b.length; j++)
+				b[j] = (byte)(rand.nextInt(10) == 0 ? rand.nextInt(256) : 0xFF);
+			int split = rand.nextInt(b.length + 1);
+			Adler32 ref = new Adler32();
+			ref.update(b);
+			int adler = ZlibDecompressor.updateAdler32(1, b, 0, split);
+			adler = ZlibDecompressor.updateAdler32(adler, b, split, b.length - split);
+			Assert.assertEquals((int)ref.getValue(), adler);
+		}
+	}
+	
+	
+	@Test(expected=DataFormatException.class)
+	public void testChecksumMismatch() throws IOException, DataFormatException {
+		byte[] comp = compress(randomText(1000), null);
+		comp[comp.length - 1] ^= 0x10;
+		ZlibDecompressor.decompress(new BufferedBitInputStream(new ByteArrayInputStream(comp)), null);
+	}
+	
+	
+	@Test(expected=DataFormatException.class)
+	public void testHeaderCheck() throws IOException, DataFormatException {
+		ZlibDecompressor.decompress(new BufferedBitInputStream(new ByteArrayInputStream(new byte[]{0x78, (byte)0x9D, 3, 0, 0, 0, 0, 1})), null);
+	}
+	
+	
+	@Test(expected=DataFormatException.class)
+	public void testMissingDictionary() throws IOException, DataFormatException {
+		byte[] comp = compress(randomText(1000), randomText(100));
+		ZlibDecompressor.decompress(new BufferedBitInputStream(new ByteArrayInputStream(comp)), null);
+	}
+	
+	
+	@Test(expected=DataFormatException.class)
+	public void testWrongDictionary() throws IOException, DataFormatException {
+		byte[] comp = compress(randomText(1000), new byte[]{1, 2, 3});
+		ZlibDecompressor.decompress(new BufferedBitInputStream(new ByteArrayInputStream(comp)), new byte[]{1, 2, 4});
+	}
+	
+	
+	@Test public void testLimits() throws IOException, DataFormatException {
+		for (int i = 0; i < 30; i++) {
+			byte[] data = randomText(rand.nextInt(300000));
+			byte[] comp = compress(data, null);
+			
+			// Exactly the output length is allowed
+			ByteArrayOutputStream out = new ByteArrayOutputStream();
+			ZlibDecompressor.decompress(new BufferedBitInputStream(new ByteArrayInputStream(comp)), out, null, new DecompressionLimits(data.length, Double.POSITIVE_INFINITY));
+			Assert.assertArrayEquals(data, out.toByteArray());
+			
+			// One byte less is not, and nothing beyond the limit is written
+			if (data.length > 0) {
+				out.reset();
+				try {
+					ZlibDecompressor.decompress(new BufferedBitInputStream(new ByteArrayInputStream(comp)), out, null, new DecompressionLimits(data.length - 1, Double.POSITIVE_INFINITY));
+					Assert.fail();
+				} catch (DecompressionLimitException e) {}  // Pass
+				Assert.assertTrue(out.size() < data.length);
+			}
+		}
+		
+		// About 10 KB of input expands to 10 MB, a ratio of about 1000
+		byte[] comp = compress(new byte[10000000], null, 9);
+		try {
+			ZlibDecompressor.decompress(new BufferedBitInputStream(new ByteArrayInputStream(comp)), new ByteArrayOutputStream(), null, new DecompressionLimits(Long.MAX_VALUE, 100));
+			Assert.fail();
+		} catch (DecompressionLimitException e) {}  // Pass
+	}
+	
+	
+	// Returns random bytes from a small alphabet, so that the data is compressible.
+	private static byte[] randomText(int len) {
+		byte[] result = new byte[len];
+		for (int i = 0; i < len; i++)
+			result[i] = (byte)('a' + rand.nextInt(5));
+		return result;
+	}
+	
+	
+	private static byte[] compress(byte[] data, byte[] dict) {
+		return compress(data, dict, rand.nextInt(10));
+	}
+	
+	
+	// Returns the zlib compression of the given data at the given level, using the given preset dictionary if not null.
+	private static byte[] compress(byte[] data, byte[] dict, int level) {
+		Deflater def = new Deflater(level);
+		if (dict != null)
+			def.setDictionary(dict);
+		def.setInput(data);
+		def.finish();
+		ByteArrayOutputStream bout = new ByteArrayOutputStream();
+		byte[] buf = new byte[4096];
+		while (!def.finished())
+			bout.write(buf, 0, def.deflate(buf));
+		def.end();
+		return bout.toByteArray();
+	}
+	
+	
+	private static Random rand = new Random();
+	
+}
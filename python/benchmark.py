@@ -0,0 +1,116 @@
+# 
+# Simple DEFLATE decompressor
+# Copyright (c) Project Nayuki
+# 
+# https://www.nayuki.io/page/simple-deflate-decompressor
+# https://github.com/nayuki/Simple-DEFLATE-decompressor
+# 
+
+# Measures the decompression speed of deflatedecompress, and of zlib for reference.
+# Usage: python benchmark.py [-n Repeats] [File/Directory ...]
+# Without arguments this runs on synthetic data that exercises stored blocks, fixed and
+# dynamic Huffman blocks, long matches, and tiny payloads. Otherwise each given file (or each
+# file in a given directory, such as the Silesia or Canterbury corpus or slices of enwik8)
+# is compressed at the default level and measured. For each method this prints the best
+# throughput in MB/s (10^6 bytes per second) over the repeats, and the peak memory
+# allocated during one run per decompressed byte (as traced by tracemalloc).
+
+import io, pathlib, random, sys, timeit, tracemalloc, zlib
+import deflatedecompress
+
+
+def main(argv):
+	repeats = 3
+	args = argv[1 : ]
+	if len(args) >= 2 and args[0] == "-n":
+		repeats = int(args[1])
+		args = args[2 : ]
+	cases = synthetic_cases() if len(args) == 0 else [c for arg in args for c in file_cases(pathlib.Path(arg))]
+	
+	print(f"{'Case':24} {'Method':24} {'MB/s':>10} {'Peak B/B':>10}")
+	for (name, payloads, datas) in cases:
+		size = sum(len(d) for d in datas)
+		for (methodname, func) in METHODS:
+			# Check the output once before timing
+			outputs = [func(p) for p in payloads]
+			if outputs != datas:
+				raise AssertionError(f"Output mismatch: {methodname} on {name}")
+			
+			tracemalloc.start()
+			run_all(func, payloads)
+			peak = tracemalloc.get_traced_memory()[1]
+			tracemalloc.stop()
+			
+			best = min(timeit.repeat(lambda: run_all(func, payloads), number=1, repeat=repeats))
+			print(f"{name:24} {methodname:24} {size / best / 1e6:10.3f} {peak / max(size, 1):10.3f}")
+
+
+def run_all(func, payloads):
+	for p in payloads:
+		func(p)
+
+
+
+# ---- Benchmark inputs ----
+
+def synthetic_cases():
+	rand = random.Random(1)
+	size = 256 * 1024  # Much smaller than in Java, because the pure-Python decoder is slow
+	result = []
+	
+	# Incompressible data, which the compressor emits as stored blocks
+	data = rand.randbytes(size)
+	result.append(("stored", [compress(data, 0)], [data]))
+	
+	# Text-like data with a shifting character set, compressed with dynamic and then with fixed codes
+	text = bytearray()
+	while len(text) < size:
+		if len(text) >= 10 and rand.randrange(3) == 0:
+			dist = rand.randrange(min(len(text), 30000)) + 1
+			for _ in range(rand.randrange(30) + 3):
+				text.append(text[-dist])
+		else:
+			text.append(ord("a") + (len(text) >> 16) % 10 + rand.randrange(16))
+	text = bytes(text[ : size])
+	result.append(("dynamic", [compress(text, 6)], [text]))
+	result.append(("fixed", [compress(text, 6, zlib.Z_FIXED)], [text]))
+	
+	# A repeated pattern with rare changes, which is mostly maximum-length matches
+	repeats = bytearray()
+	for i in range(size):
+		repeats.append(rand.randrange(256) if (i < 1000 or rand.randrange(5000) == 0) else repeats[i - 1000])
+	repeats = bytes(repeats)
+	result.append(("long matches", [compress(repeats, 9)], [repeats]))
+	
+	# Many small messages, each a separate stream
+	msgs = [f'{{"id":{i},"name":"item{rand.randrange(1000)}","tags":["a","b"],"value":{rand.getrandbits(31)}}}'.encode("ASCII")
+		for i in range(1000)]
+	result.append(("tiny", [compress(m, 6) for m in msgs], msgs))
+	return result
+
+
+def file_cases(path):
+	if path.is_dir():
+		return [c for child in sorted(path.iterdir()) if child.is_file() for c in file_cases(child)]
+	data = path.read_bytes()
+	return [(path.name, [compress(data, 6)], [data])]
+
+
+# Returns the raw DEFLATE compression of the given data at the given level and strategy.
+def compress(data, level, strategy=zlib.Z_DEFAULT_STRATEGY):
+	comp = zlib.compressobj(level, zlib.DEFLATED, -15, 8, strategy)
+	return comp.compress(data) + comp.flush()
+
+
+
+# ---- Decompression methods ----
+
+METHODS = [
+	("deflatedecompress", lambda p: deflatedecompress.Decompressor.decompress_to_bytes(
+		deflatedecompress.BitInputStream(io.BytesIO(p)))),
+	("zlib", lambda p: zlib.decompress(p, -15)),
+]
+
+
+if __name__ == "__main__":
+	main(sys.argv)
@@ -6,7 +6,7 @@
 # https://github.com/nayuki/Simple-DEFLATE-decompressor
 # 
 
-import io
+import sys
 
 
 class CanonicalCode:
@@ -84,20 +84,38 @@ class CanonicalCode:
 				nextcode += 1
 		if nextcode != 1 << max(codelengths):
 			raise ValueError("This canonical code produces an under-full Huffman code tree")
+		
+		# This list maps every possible sequence of the next max(codelengths) bits of the input
+		# (the first bit in the least significant position) to symbol << 4 | codelength
+		# for the code that the sequence starts with, so a symbol is decoded with one lookup.
+		# Each code fills every entry whose low bits are the code's bits in reverse order.
+		self._table_bits = max(codelengths)
+		self._table = [0] * (1 << self._table_bits)
+		for (codebits, symbol) in self._code_bits_to_symbol.items():
+			codelength = codebits.bit_length() - 1
+			reversedcode = int(bin(codebits)[ : 2 : -1], 2)
+			self._table[reversedcode : : 1 << codelength] = [symbol << 4 | codelength] * (1 << (self._table_bits - codelength))
 	
 	
 	def decode_next_symbol(self, inp):
 		"""Decodes the next symbol from the given bit input stream based on this
 		canonical code. The returned symbol value is in the range [0, len(codelengths))."""
-		codebits = 1  # The start bit
-		while True:
-			# Accumulate one bit at a time on the right side until a match is found
-			# in the code_bits_to_symbol dictionary. Because the Huffman code tree is
-			# full, this loop must terminate after at most max(codelengths) iterations.
-			codebits = codebits << 1 | inp.read_no_eof()
-			result = self._code_bits_to_symbol.get(codebits, -1)
-			if result != -1:
-				return result
+		if isinstance(inp, BitInputStream):
+			# Look up the code that the upcoming bits start with, then consume only its bits
+			entry = self._table[inp.peek_bits(self._table_bits)]
+			inp.consume_bits(entry & 0xF)
+			return entry >> 4
+		
+		codebits = 0
+		for i in range(self._table_bits):
+			# Accumulate one bit at a time on the left side, with the unread bits as zeros,
+			# until the entry is for a code no longer than the bits read so far. Because the
+			# Huffman code tree is full, this loop must terminate after at most max(codelengths) iterations.
+			codebits |= inp.read_no_eof() << i
+			entry = self._table[codebits]
+			if entry & 0xF <= i + 1:
+				return entry >> 4
+		assert False, "Unreachable"
 	
 	
 	def __str__(self):
@@ -118,9 +136,7 @@ class Decompressor:
 	@staticmethod
 	def decompress_to_bytes(bitin):
 		"""Reads from the given input stream, decompress the data, and returns a new byte list."""
-		out = io.BytesIO()
-		Decompressor.decompress_to_stream(bitin, out)
-		return out.getvalue()
+		return bytes(Decompressor(bitin, None)._output)
 	
 	
 	@staticmethod
@@ -134,8 +150,14 @@ class Decompressor:
 	def __init__(self, bitin, out):
 		# Initialize fields
 		self._input = bitin
-		self._output = out
-		self._dictionary = ByteHistory(32 * 1024)
+		# Whether the input is this module's BitInputStream, whose bit buffer and bulk reads are used directly.
+		# Any other object that provides read(), read_no_eof(), read_byte() and get_bit_position() is read bit by bit.
+		self._fast_input = isinstance(bitin, BitInputStream)
+		# The decompressed data, which is also the dictionary for back-references. When writing
+		# to a stream, all but the last 32 KiB are written out whenever enough data has built up.
+		self._output = bytearray()
+		self._stream = out
+		self._flush_length = sys.maxsize if (out is None) else (32 * 1024 + Decompressor._FLUSH_SIZE)
 		
 		# Process the stream of blocks
 		while True:
@@ -155,8 +177,26 @@ class Decompressor:
 				raise ValueError("Reserved block type")
 			else:
 				assert False, "Impossible value"
+			if len(self._output) >= self._flush_length:
+				self._flush(32 * 1024)
 			if isfinal:
 				break
+		if out is not None:
+			self._flush(0)
+	
+	
+	# Writes all but the given number of most recent bytes of the output to the stream, and removes them.
+	# The bytes are passed as a memoryview of the output buffer, so they are not copied again.
+	def _flush(self, keep):
+		n = len(self._output) - keep
+		if n > 0:
+			with memoryview(self._output)[ : n] as view:
+				self._stream.write(view)
+			del self._output[ : n]
+	
+	
+	# The number of bytes of output beyond the dictionary to build up before writing to the stream.
+	_FLUSH_SIZE = 256 * 1024
 	
 	
 	# -- The constant code trees for static Huffman codes (btype = 1) --
@@ -240,31 +280,112 @@ class Decompressor:
 			self._input.read_no_eof()
 		
 		# Read length
-		len  = self._read_int(16)
+		len_ = self._read_int(16)
 		nlen = self._read_int(16)
-		if len ^ 0xFFFF != nlen:
-			raise valueError("Invalid length in uncompressed block")
+		if len_ ^ 0xFFFF != nlen:
+			raise ValueError("Invalid length in uncompressed block")
 		
-		# Copy bytes
-		for _ in range(len):
-			b = self._input.read_byte()
-			if b == -1:
+		# Copy bytes in bulk, or one at a time from a generic stream
+		if self._fast_input:
+			b = self._input.read_bytes(len_)
+			if len(b) < len_:
 				raise EOFError()
-			self._output.write(bytes((b,)))
-			self._dictionary.append(b)
+			self._output += b
+		else:
+			for _ in range(len_):
+				b = self._input.read_byte()
+				if b == -1:
+					raise EOFError()
+				self._output.append(b)
+				if len(self._output) >= self._flush_length:
+					self._flush(32 * 1024)
 	
 	
 	# Decompresses a Huffman-coded block from the bit input stream based on the given Huffman codes.
+	# For speed, the input's bit buffer is held in local variables while the block is decoded, and it is
+	# topped up whenever it might not hold a whole length and distance pair with their extra bits
+	# (at most 15 + 5 + 15 + 13 = 48 bits). Each match is copied as a slice of the output.
 	def _decompress_huffman_block(self, litlencode, distcode):
 		# litlencode cannot be None, but distcode is allowed to be None
+		if not self._fast_input:
+			self._decompress_huffman_block_generic(litlencode, distcode)
+			return
+		inp = self._input
+		output = self._output
+		littable = litlencode._table
+		litmask = len(littable) - 1
+		if distcode is not None:
+			disttable = distcode._table
+			distmask = len(disttable) - 1
+		bitbuf, bitlen = inp._bitbuf, inp._bitbuflen
+		try:
+			while True:
+				if bitlen < 48:
+					# Also check here for output to flush, because a run of literals never reaches the check after a match
+					if len(output) >= self._flush_length:
+						self._flush(32 * 1024)
+					bitbuf, bitlen = inp._fill(bitbuf, bitlen)
+				entry = littable[bitbuf & litmask]
+				n = entry & 0xF
+				if n > bitlen:
+					raise EOFError()
+				bitbuf >>= n
+				bitlen -= n
+				sym = entry >> 4
+				
+				if sym < 256:  # Literal byte
+					output.append(sym)
+					continue
+				if sym == 256:  # End of block
+					break
+				
+				# Length and distance for copying
+				if sym > 285:
+					raise ValueError("Reserved length symbol: " + str(sym))
+				n = Decompressor._LENGTH_EXTRA_BITS[sym - 257]
+				if n > bitlen:
+					raise EOFError()
+				run = Decompressor._LENGTH_BASES[sym - 257] + (bitbuf & ((1 << n) - 1))
+				bitbuf >>= n
+				bitlen -= n
+				assert 3 <= run <= 258, "Invalid run length"
+				
+				if distcode is None:
+					raise ValueError("Length symbol encountered with empty distance code")
+				entry = disttable[bitbuf & distmask]
+				n = entry & 0xF
+				if n > bitlen:
+					raise EOFError()
+				bitbuf >>= n
+				bitlen -= n
+				distsym = entry >> 4
+				if distsym > 29:
+					raise ValueError("Reserved distance symbol: " + str(distsym))
+				n = Decompressor._DISTANCE_EXTRA_BITS[distsym]
+				if n > bitlen:
+					raise EOFError()
+				dist = Decompressor._DISTANCE_BASES[distsym] + (bitbuf & ((1 << n) - 1))
+				bitbuf >>= n
+				bitlen -= n
+				assert 1 <= dist <= 32768, "Invalid distance"
+				
+				Decompressor._copy(output, dist, run)
+				if len(output) >= self._flush_length:
+					self._flush(32 * 1024)
+		finally:
+			inp._bitbuf, inp._bitbuflen = bitbuf, bitlen
+	
+	
+	# Decompresses a Huffman-coded block from a generic bit input stream, reading one bit at a time.
+	def _decompress_huffman_block_generic(self, litlencode, distcode):
+		output = self._output
 		while True:
 			sym = litlencode.decode_next_symbol(self._input)
 			if sym == 256:  # End of block
 				break
 			
 			if sym < 256:  # Literal byte
-				self._output.write(bytes((sym,)))
-				self._dictionary.append(sym)
+				output.append(sym)
 			else:  # Length and distance for copying
 				run = self.decode_run_length(sym)
 				assert 3 <= run <= 258, "Invalid run length"
@@ -273,7 +394,26 @@ class Decompressor:
 				distsym = distcode.decode_next_symbol(self._input)
 				dist = self._decode_distance(distsym)
 				assert 1 <= dist <= 32768, "Invalid distance"
-				self._dictionary.copy(dist, run, self._output)
+				Decompressor._copy(output, dist, run)
+			if len(output) >= self._flush_length:
+				self._flush(32 * 1024)
+	
+	
+	# Appends to the given output the given number of bytes starting at the given distance back from its end.
+	@staticmethod
+	def _copy(output, dist, run):
+		start = len(output) - dist
+		if start < 0:
+			# Rare case where the copy starts before the beginning of the output, which reads as zeros
+			for _ in range(run):
+				i = len(output) - dist
+				output.append(output[i] if (i >= 0) else 0)
+		elif run <= dist:
+			output += output[start : start + run]
+		else:
+			# The copy overlaps the bytes it produces, so it is
+			# the last 'dist' bytes repeated and then truncated
+			output += (output[start : ] * (run // dist + 1))[ : run]
 	
 	
 	# -- Symbol decoding methods --
@@ -310,104 +450,99 @@ class Decompressor:
 			raise ValueError("Reserved distance symbol: " + str(sym))
 	
 	
+	# For each length symbol from 257 to 285, and each distance symbol from 0 to 29, the base value
+	# and the number of extra bits to add to it, following the same formulas as decode_run_length() and _decode_distance().
+	_LENGTH_EXTRA_BITS = [0] * 8 + [(sym - 261) // 4 for sym in range(265, 285)] + [0]
+	_LENGTH_BASES = [sym - 254 for sym in range(257, 265)] + [(((sym - 265) % 4 + 4) << ((sym - 261) // 4)) + 3 for sym in range(265, 285)] + [258]
+	_DISTANCE_EXTRA_BITS = [0] * 4 + [sym // 2 - 1 for sym in range(4, 30)]
+	_DISTANCE_BASES = [sym + 1 for sym in range(4)] + [((sym % 2 + 2) << (sym // 2 - 1)) + 1 for sym in range(4, 30)]
+	
+	
 	# -- Utility method --
 	
 	# Reads the given number of bits from the bit input stream as a single integer, packed in little endian.
 	def _read_int(self, numbits):
 		if numbits < 0:
 			raise ValueError()
+		if self._fast_input:
+			return self._input.read_bits(numbits)
 		return sum(self._input.read_no_eof() << i for i in range(numbits))
 
 
 
-class ByteHistory:
-	
-	"""Stores a finite recent history of a byte stream. Useful as an implicit
-	dictionary for Lempel-Ziv schemes. Mutable and not thread-safe."""
-	
-	def __init__(self, size):
-		"""Creates a byte history of the given size, initialized to zeros."""
-		if size < 1:
-			raise ValueError("Size must be positive")
-		# Circular buffer of byte data.
-		self._data = [0] * size
-		# Index of next byte to write to, always in the range [0, len(data)).
-		self._index = 0
-	
-	
-	def append(self, b):
-		"""Appends the specified byte to this history.
-		This overwrites the byte value at 'size' positions ago."""
-		assert 0 <= self._index < len(self._data)
-		self._data[self._index] = b
-		self._index = (self._index + 1) % len(self._data)
-	
-	
-	def copy(self, dist, count, out):
-		"""Copies 'count' bytes starting at 'dist' bytes ago to the
-		given output stream and also back into this buffer itself.
-		Note that if the count exceeds the distance, then some of the output
-		data will be a copy of data that was copied earlier in the process."""
-		if count < 0 or not (1 <= dist <= len(self._data)):
-			raise ValueError()
-		
-		readindex = (self._index - dist) % len(self._data)
-		for _ in range(count):
-			b = self._data[readindex]
-			readindex = (readindex + 1) % len(self._data)
-			out.write(bytes((b,)))
-			self.append(b)
-
-
-
 class BitInputStream:
 	
 	"""A stream of bits that can be read. Because they come from an underlying byte stream, the
 	total number of bits is always a multiple of 8. Bits are packed in little endian within a byte.
-	For example, the byte 0x87 reads as the sequence of bits [1,1,1,0,0,0,0,1]."""
+	For example, the byte 0x87 reads as the sequence of bits [1,1,1,0,0,0,0,1].
+	The underlying stream is read in large chunks, so it is generally positioned past the bits
+	that have been read; any data after the bits must be read through read_byte() or read_bytes()."""
 	
 	def __init__(self, inp):
 		"""Constructs a bit input stream based on the given byte input stream."""
 		# The underlying byte stream to read from.
 		self._input = inp
-		# Either in the range [0x00, 0xFF] if bits are available, or -1 if end of stream is reached.
-		self._current_byte = 0
-		# Number of remaining bits in the current byte, always between 0 and 7 (inclusive).
-		self._num_bits_remaining = 0
+		# The chunk most recently read from the underlying stream, and the index of its next byte to use.
+		self._chunk = b""
+		self._chunk_index = 0
+		# Upcoming bits of the stream, with the next bit in the least significant position, and how many there are.
+		# The bits above that count are zero. The count is a multiple of 8 plus the bits remaining in the current byte.
+		self._bitbuf = 0
+		self._bitbuflen = 0
 	
 	
 	def get_bit_position(self):
 		"""Returns the current bit position, which ascends from 0 to 7 as bits are read."""
-		assert 0 <= self._num_bits_remaining <= 7
-		return -self._num_bits_remaining % 8
+		return -self._bitbuflen % 8
 	
 	
 	def read_byte(self):
 		"""Discards the remainder of the current byte (if any) and reads the next
 		whole byte from the stream. Returns -1 if the end of stream is reached."""
-		self._current_byte = 0
-		self._num_bits_remaining = 0
-		b = self._input.read(1)
-		if len(b) == 0:
-			return -1
-		return b[0]
+		self._discard_partial_byte()
+		if self._bitbuflen == 0:
+			self._bitbuf, self._bitbuflen = self._fill(0, 0)
+			if self._bitbuflen == 0:
+				return -1
+		result = self._bitbuf & 0xFF
+		self._bitbuf >>= 8
+		self._bitbuflen -= 8
+		return result
+	
+	
+	def read_bytes(self, n):
+		"""Discards the remainder of the current byte (if any) and reads the next n whole
+		bytes from the stream, returning them as bytes. Fewer bytes are returned only
+		if the end of stream is reached. The bytes are not read bit by bit."""
+		if n < 0:
+			raise ValueError()
+		self._discard_partial_byte()
+		
+		# Take the whole bytes in the bit buffer first, then slices of the chunks
+		k = min(self._bitbuflen // 8, n)
+		result = bytearray((self._bitbuf & ((1 << (k * 8)) - 1)).to_bytes(k, "little"))
+		self._bitbuf >>= k * 8
+		self._bitbuflen -= k * 8
+		while len(result) < n:
+			if self._chunk_index == len(self._chunk) and not self._read_chunk():
+				break
+			k = min(n - len(result), len(self._chunk) - self._chunk_index)
+			result += self._chunk[self._chunk_index : self._chunk_index + k]
+			self._chunk_index += k
+		return bytes(result)
 	
 	
 	def read(self):
 		"""Reads a bit from this stream. Returns 0 or 1 if a bit is available, or -1 if
 		the end of stream is reached. The end of stream always occurs on a byte boundary."""
-		if self._current_byte == -1:
-			return -1
-		if self._num_bits_remaining == 0:
-			b = self._input.read(1)
-			if len(b) == 0:
-				self._current_byte = -1
+		if self._bitbuflen == 0:
+			self._bitbuf, self._bitbuflen = self._fill(0, 0)
+			if self._bitbuflen == 0:
 				return -1
-			self._current_byte = b[0]
-			self._num_bits_remaining = 8
-		assert self._num_bits_remaining > 0
-		self._num_bits_remaining -= 1
-		return (self._current_byte >> (7 - self._num_bits_remaining)) & 1
+		result = self._bitbuf & 1
+		self._bitbuf >>= 1
+		self._bitbuflen -= 1
+		return result
 	
 	
 	def read_no_eof(self):
@@ -419,8 +554,65 @@ class BitInputStream:
 		return result
 	
 	
+	def read_bits(self, numbits):
+		"""Reads the given number of bits from this stream as a single integer, packed
+		in little endian. Raises an EOFError if the end of stream is reached first."""
+		result = self.peek_bits(numbits)
+		self.consume_bits(numbits)
+		return result
+	
+	
+	def peek_bits(self, numbits):
+		"""Returns the next given number of bits (at most 56) as a single integer packed in little endian,
+		without consuming them. Bits past the end of stream read as zeros."""
+		assert 0 <= numbits <= 56
+		if self._bitbuflen < numbits:
+			self._bitbuf, self._bitbuflen = self._fill(self._bitbuf, self._bitbuflen)
+		return self._bitbuf & ((1 << numbits) - 1)
+	
+	
+	def consume_bits(self, numbits):
+		"""Skips the given number of bits, which must have been peeked just before.
+		Raises an EOFError (consuming nothing) if the end of stream is reached first."""
+		if numbits > self._bitbuflen:
+			raise EOFError()
+		self._bitbuf >>= numbits
+		self._bitbuflen -= numbits
+	
+	
 	def close(self):
 		"""Closes this stream and the underlying input stream."""
 		self._input.close()
-		self._current_byte = -1
-		self._num_bits_remaining = 0
+		self._chunk = b""
+		self._chunk_index = 0
+		self._bitbuf = 0
+		self._bitbuflen = 0
+	
+	
+	# Returns the given bit buffer state with whole bytes appended until it holds at least 56 bits, or fewer only at
+	# the end of stream. It is kept below 64 bits so that the integer stays small. The decompressor keeps the bit
+	# buffer in local variables while decoding a block, which is why the state is passed in and returned.
+	def _fill(self, bitbuf, bitlen):
+		while True:
+			k = min((63 - bitlen) // 8, len(self._chunk) - self._chunk_index)
+			if k > 0:
+				bitbuf |= int.from_bytes(self._chunk[self._chunk_index : self._chunk_index + k], "little") << bitlen
+				bitlen += k * 8
+				self._chunk_index += k
+			if bitlen >= 56 or not self._read_chunk():
+				return (bitbuf, bitlen)
+	
+	
+	# Reads the next chunk from the underlying stream, returning whether it has any bytes.
+	def _read_chunk(self):
+		self._chunk = self._input.read(BitInputStream._CHUNK_SIZE)
+		self._chunk_index = 0
+		return len(self._chunk) > 0
+	
+	
+	def _discard_partial_byte(self):
+		self._bitbuf >>= self._bitbuflen % 8
+		self._bitbuflen -= self._bitbuflen % 8
+	
+	
+	_CHUNK_SIZE = 64 * 1024
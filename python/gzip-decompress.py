@@ -6,7 +6,7 @@
 # https://github.com/nayuki/Simple-DEFLATE-decompressor
 # 
 
-import datetime, pathlib, sys, zlib
+import datetime, pathlib, sys, types, zlib
 import deflatedecompress
 
 
@@ -25,13 +25,15 @@ def main(argv):
 		# Start reading
 		with infile.open("rb") as inp:
 			
-			# Define helper read functions based on 'inp'
+			# Define helper read functions based on 'bitin', which reads 'inp'
+			# ahead in chunks, so all of the file must be read through it
+			bitin = deflatedecompress.BitInputStream(inp)
 			
 			def read_byte():
-				b = inp.read(1)
-				if len(b) == 0:
+				b = bitin.read_byte()
+				if b == -1:
 					raise EOFError()
-				return b[0]
+				return b
 			
 			def read_little_int16():
 				temp = read_byte()
@@ -109,11 +111,8 @@ def main(argv):
 			if flags & 0x04 != 0:
 				print("Flag: Extra")
 				count = read_little_int16()
-				while count > 0:  # Skip extra data
-					n = inp.read(count)
-					if n == 0:
-						raise EOFError()
-					count -= n
+				if len(bitin.read_bytes(count)) < count:  # Skip extra data
+					raise EOFError()
 			if flags & 0x08 != 0:
 				print(f"File name: {read_null_terminated_string()}")
 			if flags & 0x02 != 0:
@@ -121,27 +120,36 @@ def main(argv):
 			if flags & 0x10 != 0:
 				print(f"Comment: {read_null_terminated_string()}")
 			
-			# Decompress
+			# Decompress straight to the output file, checksumming each piece on the way.
+			# The decompressor writes pieces of about 256 KiB, which are still in the cache.
+			success = False
 			try:
-				bitin = deflatedecompress.BitInputStream(inp)
-				decomp = deflatedecompress.Decompressor.decompress_to_bytes(bitin)
-			except ValueError as e:
-				return f"Invalid or corrupt compressed data: {e}"
-			
-			# Footer
-			crc  = read_little_int32()
-			size = read_little_int32()
-		
-		# Check decompressed data's length and CRC
-		if size != len(decomp):
-			return f"Size mismatch: expected={size}, actual={len(decomp.length)}"
-		actualcrc = zlib.crc32(decomp) & 0xFFFFFFFF
-		if crc != actualcrc:
-			return f"CRC-32 mismatch: expected={crc:08X}, actual={actualcrc:08X}"
-		
-		# Write decompressed data to output file
-		with outfile.open("wb") as out:
-			out.write(decomp)
+				with outfile.open("wb") as out:
+					actualcrc = 0
+					actualsize = 0
+					def write_piece(b):
+						nonlocal actualcrc, actualsize
+						actualcrc = zlib.crc32(b, actualcrc)
+						actualsize += len(b)
+						out.write(b)
+					try:
+						deflatedecompress.Decompressor.decompress_to_stream(bitin, types.SimpleNamespace(write=write_piece))
+					except ValueError as e:
+						return f"Invalid or corrupt compressed data: {e}"
+					
+					# Footer
+					crc  = read_little_int32()
+					size = read_little_int32()
+					
+					# Check decompressed data's length (modulo 2^32) and CRC
+					if size != actualsize & 0xFFFFFFFF:
+						return f"Size mismatch: expected={size}, actual={actualsize & 0xFFFFFFFF}"
+					if crc != actualcrc:
+						return f"CRC-32 mismatch: expected={crc:08X}, actual={actualcrc:08X}"
+					success = True
+			finally:
+				if not success:  # Don't leave partial or unverified output behind
+					outfile.unlink(missing_ok=True)
 		
 	except IOError as e:
 		return f"I/O exception: {e}"